@@ -0,0 +1,423 @@
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <vector>
+#include <benchmark/benchmark.h>
+
+#include "bench_utils.h"
+#include "custom_allocator.h"
+#include "ring_buffer.h"
+#include "sharded_counter.h"
+#include "virtual_arena.h"
+
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+
+//Multi threaded allocator workloads closer to a game than the fixed size loops of bench_custom_allocation:
+//power law sizes, random frees, frees from another thread and long lived blocks mixed with short lived ones.
+//All the threads share one heap, the single threaded allocators are behind a mutex. The linear, stack and
+//frame allocators can't free a block in any order and are not part of it.
+//Counters: items_per_second counts the allocations, rss_mb the memory made resident by the run and
+//fragmentation the part of it not holding live bytes at the end of the run.
+
+static constexpr int maxThreads = 64;
+static constexpr std::size_t alignment = 8;
+static constexpr std::size_t minWorkloadSize = 16;
+static constexpr std::size_t maxWorkloadSize = 1024;
+static constexpr std::size_t batchSize = 16;
+//blocks kept alive by one thread: the random frees and the long lived blocks
+static constexpr std::size_t liveBlocks = 256;
+static constexpr std::size_t ringCapacity = 256;
+//blocks owned by one thread at the same time, sizes the heaps
+static constexpr std::size_t maxBlocksPerThread = liveBlocks + ringCapacity + batchSize;
+
+//fresh pages from the system, only resident once an allocator touches them: a malloc'd buffer could reuse
+//memory of the previous run and hide it from the rss counter
+class HeapBuffer
+{
+public:
+    explicit HeapBuffer(std::size_t size) : arena_(size), data_(static_cast<char*>(arena_.Allocate(size, 64))), size_(size) {}
+    [[nodiscard]] char* data() const { return data_; }
+    [[nodiscard]] std::size_t size() const { return size_; }
+private:
+    VirtualArena arena_;
+    char* data_;
+    std::size_t size_;
+};
+
+//room for the live blocks of every thread with their headers and the fragmentation,
+//plus what a thread cache can keep
+static std::size_t HeapSize(int threads)
+{
+    return static_cast<std::size_t>(threads) * (maxBlocksPerThread * 512 + (512 << 10));
+}
+
+struct MallocHeap
+{
+    explicit MallocHeap(int) {}
+    void* Allocate(std::size_t size) { return std::malloc(size); }
+    void Deallocate(void* ptr) { std::free(ptr); }
+};
+
+//single threaded allocator shared behind a mutex
+template<typename T>
+class LockedHeap
+{
+public:
+    template<typename... Args>
+    explicit LockedHeap(std::size_t size, Args... args) : buffer_(size), allocator_(buffer_.data(), buffer_.size(), args...) {}
+    void* Allocate(std::size_t size)
+    {
+        std::lock_guard<std::mutex> guard(lock_);
+        return allocator_.Allocate(size, alignment);
+    }
+    void Deallocate(void* ptr)
+    {
+        std::lock_guard<std::mutex> guard(lock_);
+        allocator_.Deallocate(ptr);
+    }
+private:
+    HeapBuffer buffer_;
+    T allocator_;
+    std::mutex lock_;
+};
+
+struct FreeListHeap : LockedHeap<FreeListAllocator>
+{
+    explicit FreeListHeap(int threads) : LockedHeap<FreeListAllocator>(HeapSize(threads)) {}
+};
+
+struct TlsfHeap : LockedHeap<TlsfAllocator>
+{
+    explicit TlsfHeap(int threads) : LockedHeap<TlsfAllocator>(HeapSize(threads)) {}
+};
+
+//blocks rounded to a power of two, twice the room
+struct BuddyHeap : LockedHeap<BuddyAllocator>
+{
+    explicit BuddyHeap(int threads) : LockedHeap<BuddyAllocator>(2 * HeapSize(threads), minWorkloadSize) {}
+};
+
+//every size takes a block of the biggest size
+struct PoolHeap : LockedHeap<PoolAllocator>
+{
+    explicit PoolHeap(int threads) :
+        LockedHeap<PoolAllocator>(threads * maxBlocksPerThread * maxWorkloadSize, maxWorkloadSize, alignment) {}
+};
+
+class ConcurrentPoolHeap
+{
+public:
+    explicit ConcurrentPoolHeap(int threads) :
+        buffer_(threads * maxBlocksPerThread * maxWorkloadSize),
+        allocator_(buffer_.data(), buffer_.size(), maxWorkloadSize, alignment) {}
+    void* Allocate(std::size_t size) { return allocator_.Allocate(size, alignment); }
+    void Deallocate(void* ptr) { allocator_.Deallocate(ptr); }
+private:
+    HeapBuffer buffer_;
+    ConcurrentPoolAllocator allocator_;
+};
+
+class ThreadCachingHeap
+{
+public:
+    explicit ThreadCachingHeap(int threads) :
+        buffer_(HeapSize(threads)), backing_(buffer_.data(), buffer_.size()), allocator_(backing_) {}
+    void* Allocate(std::size_t size) { return allocator_.Allocate(size, alignment); }
+    void Deallocate(void* ptr) { allocator_.Deallocate(ptr); }
+private:
+    HeapBuffer buffer_;
+    FreeListAllocator backing_;
+    ThreadCachingAllocator allocator_;
+};
+
+template<typename Heap>
+struct SharedHeap
+{
+    static inline std::unique_ptr<Heap> heap;
+};
+static std::size_t residentBefore = 0;
+//requested bytes of the live blocks, each thread publishes its changes once per iteration
+static ShardedCounter<std::int64_t> liveBytes;
+
+//thread 0 builds the heap before the loop, the other threads only use it inside the loop
+template<typename Heap>
+static void SetupHeap(benchmark::State& state)
+{
+    if (state.thread_index() == 0) {
+        SharedHeap<Heap>::heap.reset();
+        liveBytes.Reset();
+#ifdef __GLIBC__
+        //give the memory freed by the previous runs back, the malloc runs start from the same baseline
+        malloc_trim(0);
+#endif
+        residentBefore = GetResidentMemory();
+        SharedHeap<Heap>::heap = std::make_unique<Heap>(state.threads());
+    }
+}
+
+//P(size) proportional to 1/size²: mostly small blocks and a few up to maxWorkloadSize
+static std::vector<std::uint32_t> PowerLawSizes(std::size_t count, unsigned seed)
+{
+    std::mt19937 gen(seed);
+    std::uniform_real_distribution<double> dis(0.0, 1.0);
+    constexpr double ratio = static_cast<double>(minWorkloadSize) / maxWorkloadSize;
+    std::vector<std::uint32_t> sizes(count);
+    for (auto& size : sizes)
+    {
+        size = static_cast<std::uint32_t>(minWorkloadSize / (1.0 - dis(gen) * (1.0 - ratio)));
+    }
+    return sizes;
+}
+
+struct Block
+{
+    void* ptr = nullptr;
+    std::size_t size = 0;
+};
+
+//thread side of a workload: its random sizes and indices drawn before the loop, and its counters
+class ThreadWorkload
+{
+public:
+    explicit ThreadWorkload(const benchmark::State& state) :
+        threadIndex_(state.thread_index()), sizes_(PowerLawSizes(tableSize, 42 + state.thread_index())), indices_(tableSize)
+    {
+        std::mt19937 gen(1337 + state.thread_index());
+        for (auto& index : indices_)
+        {
+            index = static_cast<std::uint32_t>(gen());
+        }
+    }
+
+    template<typename Heap>
+    Block Allocate(Heap& heap)
+    {
+        const std::size_t size = sizes_[sizeStep_++ % tableSize];
+        void* ptr = heap.Allocate(size);
+        if (ptr == nullptr) [[unlikely]]
+        {
+            failures_++;
+            return {};
+        }
+        allocations_++;
+        liveDelta_ += static_cast<std::int64_t>(size);
+        return { ptr, size };
+    }
+
+    template<typename Heap>
+    void Deallocate(Heap& heap, Block& block)
+    {
+        if (block.ptr == nullptr)
+            return;
+        heap.Deallocate(block.ptr);
+        liveDelta_ -= static_cast<std::int64_t>(block.size);
+        block = {};
+    }
+
+    std::size_t NextIndex(std::size_t count) { return indices_[indexStep_++ % tableSize] % count; }
+
+    void Publish()
+    {
+        liveBytes.Increment(threadIndex_, liveDelta_);
+        liveDelta_ = 0;
+    }
+
+    //after the loop, before freeing the live blocks: every thread published its last iteration before the
+    //end of the loop, the memory counters of thread 0 see all of them
+    void Report(benchmark::State& state) const
+    {
+        state.SetItemsProcessed(static_cast<std::int64_t>(allocations_));
+        state.counters["failed"] = static_cast<double>(failures_);
+        if (state.thread_index() != 0)
+            return;
+        const double resident = static_cast<double>(GetResidentMemory()) - static_cast<double>(residentBefore);
+        const double live = static_cast<double>(liveBytes.Read());
+        state.counters["rss_mb"] = std::max(resident, 0.0) / (1 << 20);
+        if (live > 0 && resident > live)
+            state.counters["fragmentation"] = 1.0 - live / resident;
+    }
+
+private:
+    static constexpr std::size_t tableSize = 4096;
+    std::size_t threadIndex_;
+    std::vector<std::uint32_t> sizes_;
+    std::vector<std::uint32_t> indices_;
+    std::size_t sizeStep_ = 0;
+    std::size_t indexStep_ = 0;
+    std::size_t allocations_ = 0;
+    std::size_t failures_ = 0;
+    std::int64_t liveDelta_ = 0;
+};
+
+//batches of power law sized blocks, freed in allocation order
+template<typename Heap>
+static void BM_PowerLaw(benchmark::State& state) {
+    SetupHeap<Heap>(state);
+    ThreadWorkload workload(state);
+    std::array<Block, batchSize> batch;
+    for (auto _ : state) {
+        Heap& heap = *SharedHeap<Heap>::heap;
+        for (auto& block : batch)
+        {
+            block = workload.Allocate(heap);
+        }
+        benchmark::DoNotOptimize(batch.data());
+        for (auto& block : batch)
+        {
+            workload.Deallocate(heap, block);
+        }
+        workload.Publish();
+    }
+    workload.Report(state);
+}
+
+//frees in random order: each step frees a random live block of the thread and allocates its replacement
+template<typename Heap>
+static void BM_Interleaved(benchmark::State& state) {
+    SetupHeap<Heap>(state);
+    ThreadWorkload workload(state);
+    //filled by the first iterations, the heap does not exist yet before the loop
+    std::vector<Block> live(liveBlocks);
+    for (auto _ : state) {
+        Heap& heap = *SharedHeap<Heap>::heap;
+        for (std::size_t i = 0; i < batchSize; i++)
+        {
+            Block& block = live[workload.NextIndex(live.size())];
+            workload.Deallocate(heap, block);
+            block = workload.Allocate(heap);
+            benchmark::DoNotOptimize(block.ptr);
+        }
+        workload.Publish();
+    }
+    workload.Report(state);
+    for (auto& block : live)
+    {
+        workload.Deallocate(*SharedHeap<Heap>::heap, block);
+    }
+}
+
+using BlockRing = JobSystem::SpscRingBuffer<Block, ringCapacity>;
+static std::vector<std::unique_ptr<BlockRing>> rings;
+
+//blocks freed by another thread than the one that allocated them: threads 2k and 2k+1 are paired
+//by a ring, the even one allocates and the odd one frees. A thread without a partner frees its own blocks.
+template<typename Heap>
+static void BM_ProducerConsumer(benchmark::State& state) {
+    SetupHeap<Heap>(state);
+    if (state.thread_index() == 0) {
+        rings.clear();
+        for (int i = 0; i < (state.threads() + 1) / 2; i++)
+        {
+            rings.push_back(std::make_unique<BlockRing>());
+        }
+    }
+    ThreadWorkload workload(state);
+    const int index = state.thread_index();
+    const bool paired = (index ^ 1) < state.threads();
+    const bool producer = index % 2 == 0;
+    for (auto _ : state) {
+        Heap& heap = *SharedHeap<Heap>::heap;
+        BlockRing& ring = *rings[index / 2];
+        //every thread runs the same number of iterations, the consumer pops exactly what its producer pushed,
+        //failed allocations included
+        if (!paired || producer)
+        {
+            for (std::size_t i = 0; i < batchSize; i++)
+            {
+                const Block block = workload.Allocate(heap);
+                while (!ring.push_back(block))
+                {
+                    std::this_thread::yield();
+                }
+            }
+        }
+        if (!paired || !producer)
+        {
+            for (std::size_t i = 0; i < batchSize; i++)
+            {
+                Block block;
+                while (!ring.pop_front(block))
+                {
+                    std::this_thread::yield();
+                }
+                workload.Deallocate(heap, block);
+            }
+        }
+        workload.Publish();
+    }
+    workload.Report(state);
+}
+
+//long lived blocks (level data, caches) scattered between short lived ones (frame data): every iteration
+//allocates a batch freed at its end and replaces one long lived block in the middle of it
+template<typename Heap>
+static void BM_Mixed(benchmark::State& state) {
+    SetupHeap<Heap>(state);
+    ThreadWorkload workload(state);
+    std::vector<Block> longLived(liveBlocks);
+    std::array<Block, batchSize> shortLived;
+    for (auto _ : state) {
+        Heap& heap = *SharedHeap<Heap>::heap;
+        for (std::size_t i = 0; i < batchSize / 2; i++)
+        {
+            shortLived[i] = workload.Allocate(heap);
+        }
+        Block& block = longLived[workload.NextIndex(longLived.size())];
+        workload.Deallocate(heap, block);
+        block = workload.Allocate(heap);
+        for (std::size_t i = batchSize / 2; i < batchSize; i++)
+        {
+            shortLived[i] = workload.Allocate(heap);
+        }
+        benchmark::DoNotOptimize(shortLived.data());
+        for (auto& shortBlock : shortLived)
+        {
+            workload.Deallocate(heap, shortBlock);
+        }
+        workload.Publish();
+    }
+    workload.Report(state);
+    for (auto& longBlock : longLived)
+    {
+        workload.Deallocate(*SharedHeap<Heap>::heap, longBlock);
+    }
+}
+
+BENCHMARK_TEMPLATE(BM_PowerLaw, MallocHeap)->ThreadRange(1, maxThreads)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_PowerLaw, FreeListHeap)->ThreadRange(1, maxThreads)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_PowerLaw, TlsfHeap)->ThreadRange(1, maxThreads)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_PowerLaw, BuddyHeap)->ThreadRange(1, maxThreads)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_PowerLaw, PoolHeap)->ThreadRange(1, maxThreads)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_PowerLaw, ConcurrentPoolHeap)->ThreadRange(1, maxThreads)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_PowerLaw, ThreadCachingHeap)->ThreadRange(1, maxThreads)->UseRealTime();
+
+BENCHMARK_TEMPLATE(BM_Interleaved, MallocHeap)->ThreadRange(1, maxThreads)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_Interleaved, FreeListHeap)->ThreadRange(1, maxThreads)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_Interleaved, TlsfHeap)->ThreadRange(1, maxThreads)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_Interleaved, BuddyHeap)->ThreadRange(1, maxThreads)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_Interleaved, PoolHeap)->ThreadRange(1, maxThreads)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_Interleaved, ConcurrentPoolHeap)->ThreadRange(1, maxThreads)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_Interleaved, ThreadCachingHeap)->ThreadRange(1, maxThreads)->UseRealTime();
+
+BENCHMARK_TEMPLATE(BM_ProducerConsumer, MallocHeap)->ThreadRange(1, maxThreads)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_ProducerConsumer, FreeListHeap)->ThreadRange(1, maxThreads)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_ProducerConsumer, TlsfHeap)->ThreadRange(1, maxThreads)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_ProducerConsumer, BuddyHeap)->ThreadRange(1, maxThreads)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_ProducerConsumer, PoolHeap)->ThreadRange(1, maxThreads)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_ProducerConsumer, ConcurrentPoolHeap)->ThreadRange(1, maxThreads)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_ProducerConsumer, ThreadCachingHeap)->ThreadRange(1, maxThreads)->UseRealTime();
+
+BENCHMARK_TEMPLATE(BM_Mixed, MallocHeap)->ThreadRange(1, maxThreads)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_Mixed, FreeListHeap)->ThreadRange(1, maxThreads)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_Mixed, TlsfHeap)->ThreadRange(1, maxThreads)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_Mixed, BuddyHeap)->ThreadRange(1, maxThreads)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_Mixed, PoolHeap)->ThreadRange(1, maxThreads)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_Mixed, ConcurrentPoolHeap)->ThreadRange(1, maxThreads)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_Mixed, ThreadCachingHeap)->ThreadRange(1, maxThreads)->UseRealTime();
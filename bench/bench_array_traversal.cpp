@@ -6,10 +6,14 @@
 #include <cstdlib>
 #include <iostream>
 #include <cmath>
+#include <vector>
+
+#include "huge_pages.h"
 
 const unsigned long fromRange = 8;
 const unsigned long toRange = 1<<13;
 
+template<typename Allocator = std::allocator<int>>
 class Matrix {
 public:
     Matrix(size_t n) : n(n) {
@@ -33,13 +37,13 @@ public:
 
 private:
     size_t n;
-    std::vector<int> numbers;
+    std::vector<int, Allocator> numbers;
 };
 
 
 static void BM_Row(benchmark::State& state) {
     const size_t n = state.range(0);
-    Matrix m(n);
+    Matrix<> m(n);
     for (auto _ : state) {
         for (size_t i = 0; i < m.size(); i++) {
             for (size_t j = 0; j < m.size(); j++) {
@@ -57,7 +61,7 @@ BENCHMARK(BM_Row)->RangeMultiplier(2)->Range(fromRange, toRange);
 static void BM_Column(benchmark::State& state) {
 
     const size_t n = state.range(0);
-    Matrix m(n);
+    Matrix<> m(n);
     for (auto _ : state) {
         for (size_t i = 0; i < m.size(); i++) {
             for (size_t j = 0; j < m.size(); j++) {
@@ -72,7 +76,7 @@ BENCHMARK(BM_Column)->RangeMultiplier(2)->Range(fromRange, toRange);
 
 static void BM_RowWithWork(benchmark::State& state) {
     const size_t n = state.range(0);
-    Matrix m(n);
+    Matrix<> m(n);
     for (auto _ : state) {
         for (size_t i = 0; i < m.size(); i++) {
             for (size_t j = 0; j < m.size(); j++) {
@@ -90,7 +94,7 @@ BENCHMARK(BM_RowWithWork)->RangeMultiplier(2)->Range(fromRange, toRange);
 static void BM_ColumnWithWork(benchmark::State& state) {
 
     const size_t n = state.range(0);
-    Matrix m(n);
+    Matrix<> m(n);
     for (auto _ : state) {
         for (size_t i = 0; i < m.size(); i++) {
             for (size_t j = 0; j < m.size(); j++) {
@@ -106,7 +110,7 @@ BENCHMARK(BM_ColumnWithWork)->RangeMultiplier(2)->Range(fromRange, toRange);
 
 static void BM_Random(benchmark::State& state) {
     const size_t n = state.range(0);
-    Matrix m(n);
+    Matrix<> m(n);
     for (auto _ : state) {
         for (size_t i = 0; i < m.size(); i++) {
             for (size_t j = 0; j < m.size(); j++) {
@@ -120,4 +124,21 @@ static void BM_Random(benchmark::State& state) {
 
 BENCHMARK(BM_Random)->RangeMultiplier(2)->Range(fromRange, toRange);
 
+//the matrix on 2MB pages, the random column stops missing the TLB once the matrix is past a few MB
+static void BM_RandomHugePages(benchmark::State& state) {
+    const size_t n = state.range(0);
+    Matrix<HugePageAllocator<int>> m(n);
+    for (auto _ : state) {
+        for (size_t i = 0; i < m.size(); i++) {
+            for (size_t j = 0; j < m.size(); j++) {
+                m(j, rand() % n) += j;
+            }
+        }
+    }
+
+    state.counters["KB"] = n * n * sizeof(int) / 1024;
+}
+
+BENCHMARK(BM_RandomHugePages)->RangeMultiplier(2)->Range(fromRange, toRange);
+
 BENCHMARK_MAIN();
\ No newline at end of file
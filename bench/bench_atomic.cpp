@@ -6,6 +6,11 @@
 #include <memory>
 #include <mutex>
 #include <array>
+#include <thread>
+
+#include "locks.h"
+#include "ring_buffer.h"
+#include "sharded_counter.h"
 
 static constexpr std::size_t maxThreads = 64;
 
@@ -134,6 +139,23 @@ static void BM_02_AtomicArrayPadding(benchmark::State& state) {
 }
 BENCHMARK(BM_02_AtomicArrayPadding)->ThreadRange(1, maxThreads);
 
+static void BM_02_ShardedCounter(benchmark::State& state) {
+    static std::unique_ptr<ShardedCounter<int, maxThreads>> counter;
+    if (state.thread_index() == 0) {
+        // Setup code here.
+        counter = std::make_unique<ShardedCounter<int, maxThreads>>();
+    }
+    for (auto _ : state) {
+        // Run the test as normal, the shard comes from the thread itself.
+        counter->Increment();
+    }
+    if (state.thread_index() == 0) {
+        // Teardown code here.
+        benchmark::DoNotOptimize(counter->Read());
+    }
+}
+BENCHMARK(BM_02_ShardedCounter)->ThreadRange(1, maxThreads);
+
 static void BM_02_Array(benchmark::State& state) {
     static std::array<int, maxThreads> counter;
     if (state.thread_index() == 0) {
@@ -166,4 +188,114 @@ static void BM_02_ArrayPadding(benchmark::State& state) {
         benchmark::DoNotOptimize(counter);
     }
 }
-BENCHMARK(BM_02_ArrayPadding)->ThreadRange(1, maxThreads);
\ No newline at end of file
+BENCHMARK(BM_02_ArrayPadding)->ThreadRange(1, maxThreads);
+
+static constexpr std::size_t queueCapacity = 1024;
+static constexpr std::size_t batchSize = 64;
+
+//thread 0 produces, thread 1 consumes, both do the same number of iterations
+//the queue is built by thread 0 before the start barrier: it is only read inside the loop
+template<typename Queue>
+static void QueueThroughput(benchmark::State& state, const std::unique_ptr<Queue>& queue)
+{
+    int item = 0;
+    for (auto _ : state) {
+        if (state.thread_index() == 0) {
+            while (!queue->push_back(item)) {
+                std::this_thread::yield();
+            }
+            item++;
+        }
+        else {
+            while (!queue->pop_front(item)) {
+                std::this_thread::yield();
+            }
+            benchmark::DoNotOptimize(item);
+        }
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+static void BM_03_MutexRingBuffer(benchmark::State& state) {
+    static std::unique_ptr<JobSystem::ThreadSafeRingBuffer<int, queueCapacity>> queue;
+    if (state.thread_index() == 0) {
+        queue = std::make_unique<JobSystem::ThreadSafeRingBuffer<int, queueCapacity>>();
+    }
+    QueueThroughput(state, queue);
+}
+BENCHMARK(BM_03_MutexRingBuffer)->Threads(2)->UseRealTime();
+
+static void BM_03_SpscRingBuffer(benchmark::State& state) {
+    static std::unique_ptr<JobSystem::SpscRingBuffer<int, queueCapacity>> queue;
+    if (state.thread_index() == 0) {
+        queue = std::make_unique<JobSystem::SpscRingBuffer<int, queueCapacity>>();
+    }
+    QueueThroughput(state, queue);
+}
+BENCHMARK(BM_03_SpscRingBuffer)->Threads(2)->UseRealTime();
+
+static void BM_03_SpscRingBufferBatch(benchmark::State& state) {
+    static std::unique_ptr<JobSystem::SpscRingBuffer<int, queueCapacity>> queue;
+    if (state.thread_index() == 0) {
+        queue = std::make_unique<JobSystem::SpscRingBuffer<int, queueCapacity>>();
+    }
+    std::array<int, batchSize> items{};
+    for (auto _ : state) {
+        //each iteration moves a whole batch
+        std::size_t done = 0;
+        while (done < batchSize) {
+            const std::size_t count = state.thread_index() == 0 ?
+                queue->push_back(items.data() + done, batchSize - done) :
+                queue->pop_front(items.data() + done, batchSize - done);
+            if (count == 0) {
+                std::this_thread::yield();
+            }
+            done += count;
+        }
+        benchmark::DoNotOptimize(items.data());
+    }
+    state.SetItemsProcessed(state.iterations() * batchSize);
+}
+BENCHMARK(BM_03_SpscRingBufferBatch)->Threads(2)->UseRealTime();
+
+//short critical section behind each lock
+template<typename Lock>
+static void BM_04_Lock(benchmark::State& state) {
+    static std::unique_ptr<Lock> lock;
+    static int counter = 0;
+    if (state.thread_index() == 0) {
+        lock = std::make_unique<Lock>();
+    }
+    for (auto _ : state) {
+        std::lock_guard<Lock> guard(*lock);
+        counter++;
+    }
+    if (state.thread_index() == 0) {
+        benchmark::DoNotOptimize(counter);
+    }
+}
+BENCHMARK_TEMPLATE(BM_04_Lock, std::mutex)->ThreadRange(1, maxThreads)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_04_Lock, SpinLock)->ThreadRange(1, maxThreads)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_04_Lock, TicketLock)->ThreadRange(1, maxThreads)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_04_Lock, McsLock)->ThreadRange(1, maxThreads)->UseRealTime();
+
+//every thread pushes then pops one item, the ring buffer lock is the only shared state
+template<typename Lock>
+static void BM_05_RingBufferLock(benchmark::State& state) {
+    using Queue = JobSystem::ThreadSafeRingBuffer<int, queueCapacity, Lock>;
+    static std::unique_ptr<Queue> queue;
+    if (state.thread_index() == 0) {
+        queue = std::make_unique<Queue>();
+    }
+    int item = state.thread_index();
+    for (auto _ : state) {
+        queue->push_back(item);
+        queue->pop_front(item);
+        benchmark::DoNotOptimize(item);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK_TEMPLATE(BM_05_RingBufferLock, std::mutex)->ThreadRange(1, maxThreads)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_05_RingBufferLock, SpinLock)->ThreadRange(1, maxThreads)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_05_RingBufferLock, TicketLock)->ThreadRange(1, maxThreads)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_05_RingBufferLock, McsLock)->ThreadRange(1, maxThreads)->UseRealTime();
@@ -8,6 +8,7 @@
 #include <random>
 #include "vector3.h"
 #include "bench_utils.h"
+#include "huge_pages.h"
 
 const long fromRange = 8;
 
@@ -41,7 +42,7 @@ static void BM_RandomCacheBench(benchmark::State &state)
     std::vector<int> v(count);
     FillRandom(v, std::numeric_limits<int>::min(), std::numeric_limits<int>::max());
     std::vector<int> indices(count);
-    FillRandom(indices, 0, count);
+    FillRandom(indices, 0, count - 1);
     for(auto _ : state)
     {
         long sum = 0;
@@ -55,4 +56,28 @@ static void BM_RandomCacheBench(benchmark::State &state)
     state.SetLabel(bytes/1024 > 1000?std::to_string(bytes/1024/1024)+"mb":std::to_string(bytes/1024)+"kb");
 
 }
-BENCHMARK(BM_RandomCacheBench)->DenseRange(13, 26)->ReportAggregatesOnly(true);
\ No newline at end of file
+BENCHMARK(BM_RandomCacheBench)->DenseRange(13, 26)->ReportAggregatesOnly(true);
+
+//same random reads with the buffers on 2MB pages, past a few MB BM_RandomCacheBench mostly waits on TLB misses
+static void BM_RandomCacheBenchHugePages(benchmark::State &state)
+{
+    std::size_t bytes = 1u << state.range(0);
+    std::size_t count = (bytes/sizeof(int))/2u;
+    std::vector<int, HugePageAllocator<int>> v(count);
+    FillRandom(v, std::numeric_limits<int>::min(), std::numeric_limits<int>::max());
+    std::vector<int, HugePageAllocator<int>> indices(count);
+    FillRandom(indices, 0, count - 1);
+    for(auto _ : state)
+    {
+        long sum = 0;
+        for(auto i : indices)
+        {
+            sum += v[i];
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetBytesProcessed(std::size_t(state.iterations())* std::size_t(bytes));
+    state.SetLabel(bytes/1024 > 1000?std::to_string(bytes/1024/1024)+"mb":std::to_string(bytes/1024)+"kb");
+
+}
+BENCHMARK(BM_RandomCacheBenchHugePages)->DenseRange(13, 26)->ReportAggregatesOnly(true);
\ No newline at end of file
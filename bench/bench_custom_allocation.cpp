@@ -1,7 +1,13 @@
+#include <algorithm>
 #include <chrono>
+#include <array>
+#include <memory>
+#include <mutex>
+#include <vector>
 #include <benchmark/benchmark.h>
 
 #include "custom_allocator.h"
+#include "virtual_arena.h"
 
 constexpr auto allocationSize = 16;
 constexpr auto alignment = 8;
@@ -57,6 +63,32 @@ static void BM_LinearAllocator(benchmark::State& state) {
 BENCHMARK(BM_LinearAllocator)->Range(1, 512)->UseManualTime();
 
 
+static void BM_VirtualArena(benchmark::State& state) {
+    // Perform setup here
+    const auto allocationNum = state.range(0);
+    VirtualArena arena(std::size_t(1) << 30);
+    for (auto _ : state) {
+        std::chrono::duration<double> totalTime{};
+        //the committed pages are kept, like the buffer reused by BM_LinearAllocator
+        arena.Reset();
+        auto start = std::chrono::high_resolution_clock::now();
+        for (int i = 0; i < allocationNum; i++)
+        {
+            auto* ptr = arena.Allocate(allocationSize, alignment);
+            benchmark::DoNotOptimize(ptr);
+        }
+        auto end = std::chrono::high_resolution_clock::now();
+        totalTime +=
+                std::chrono::duration_cast<std::chrono::duration<double>>(
+                        end - start);
+        state.SetIterationTime(totalTime.count());
+        benchmark::ClobberMemory();
+    }
+}
+// Register the function as a benchmark
+BENCHMARK(BM_VirtualArena)->Range(1, 512)->UseManualTime();
+
+
 static void BM_StackAllocator(benchmark::State& state) {
     // Perform setup here
     const std::size_t totalSize = allocationSize * state.range(0) * 2;
@@ -108,4 +140,328 @@ static void BM_FreeListAllocator(benchmark::State& state) {
     }
 }
 // Register the function as a benchmark
-BENCHMARK(BM_FreeListAllocator)->Range(1, 512)->UseManualTime();
\ No newline at end of file
+BENCHMARK(BM_FreeListAllocator)->Range(1, 512)->UseManualTime();
+
+
+static void BM_BuddyAllocator(benchmark::State& state) {
+    // Perform setup here
+    const std::size_t totalSize = allocationSize * state.range(0) * 8 + 4096;
+    void* rootPtr = std::malloc(totalSize);
+    const auto allocationNum = state.range(0);
+    for (auto _ : state) {
+        std::chrono::duration<double> totalTime{};
+        BuddyAllocator allocator(rootPtr, totalSize, allocationSize);
+        auto start = std::chrono::high_resolution_clock::now();
+        for (int i = 0; i < allocationNum; i++)
+        {
+            auto* ptr = allocator.Allocate(allocationSize, alignment);
+            benchmark::DoNotOptimize(ptr);
+        }
+        auto end = std::chrono::high_resolution_clock::now();
+        totalTime +=
+            std::chrono::duration_cast<std::chrono::duration<double>>(
+                end - start);
+        state.SetIterationTime(totalTime.count());
+        benchmark::ClobberMemory();
+
+    }
+}
+// Register the function as a benchmark
+BENCHMARK(BM_BuddyAllocator)->Range(1, 512)->UseManualTime();
+
+
+static void BM_PoolAllocator(benchmark::State& state) {
+    // Perform setup here
+    const std::size_t totalSize = allocationSize * state.range(0);
+    void* rootPtr = std::malloc(totalSize);
+    const auto allocationNum = state.range(0);
+    for (auto _ : state) {
+        std::chrono::duration<double> totalTime{};
+        PoolAllocator allocator(rootPtr, totalSize, allocationSize, alignment);
+        auto start = std::chrono::high_resolution_clock::now();
+        for (int i = 0; i < allocationNum; i++)
+        {
+            auto* ptr = allocator.Allocate(allocationSize, alignment);
+            benchmark::DoNotOptimize(ptr);
+        }
+        auto end = std::chrono::high_resolution_clock::now();
+        totalTime +=
+            std::chrono::duration_cast<std::chrono::duration<double>>(
+                end - start);
+        state.SetIterationTime(totalTime.count());
+        benchmark::ClobberMemory();
+
+    }
+}
+// Register the function as a benchmark
+BENCHMARK(BM_PoolAllocator)->Range(1, 512)->UseManualTime();
+
+static constexpr int maxThreads = 64;
+//blocks owned at the same time by one thread
+static constexpr std::size_t threadBatch = 16;
+
+//every thread allocates a batch then frees it, all threads share the allocator
+static void BM_MallocThreads(benchmark::State& state) {
+    std::array<void*, threadBatch> ptrs{};
+    for (auto _ : state) {
+        for (auto& ptr : ptrs)
+        {
+            ptr = std::malloc(allocationSize);
+            benchmark::DoNotOptimize(ptr);
+        }
+        for (auto* ptr : ptrs)
+        {
+            std::free(ptr);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * threadBatch);
+}
+BENCHMARK(BM_MallocThreads)->ThreadRange(1, maxThreads)->UseRealTime();
+
+static void BM_ConcurrentPoolAllocatorThreads(benchmark::State& state) {
+    static std::vector<char> data;
+    static std::unique_ptr<ConcurrentPoolAllocator> allocator;
+    if (state.thread_index() == 0) {
+        data.resize(allocationSize * threadBatch * maxThreads);
+        allocator = std::make_unique<ConcurrentPoolAllocator>(data.data(), data.size(), allocationSize, alignment);
+    }
+    std::array<void*, threadBatch> ptrs{};
+    for (auto _ : state) {
+        for (auto& ptr : ptrs)
+        {
+            ptr = allocator->Allocate(allocationSize, alignment);
+            benchmark::DoNotOptimize(ptr);
+        }
+        for (auto* ptr : ptrs)
+        {
+            allocator->Deallocate(ptr);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * threadBatch);
+}
+BENCHMARK(BM_ConcurrentPoolAllocatorThreads)->ThreadRange(1, maxThreads)->UseRealTime();
+
+
+//the single threaded FreeListAllocator behind one mutex, what the thread cache avoids
+static void BM_MutexFreeListAllocatorThreads(benchmark::State& state) {
+    static std::vector<char> data;
+    static std::unique_ptr<FreeListAllocator> allocator;
+    static std::mutex lock;
+    if (state.thread_index() == 0) {
+        data.resize(1 << 20);
+        allocator = std::make_unique<FreeListAllocator>(data.data(), data.size());
+    }
+    std::array<void*, threadBatch> ptrs{};
+    for (auto _ : state) {
+        for (auto& ptr : ptrs)
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            ptr = allocator->Allocate(allocationSize, alignment);
+            benchmark::DoNotOptimize(ptr);
+        }
+        for (auto* ptr : ptrs)
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            allocator->Deallocate(ptr);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * threadBatch);
+}
+BENCHMARK(BM_MutexFreeListAllocatorThreads)->ThreadRange(1, maxThreads)->UseRealTime();
+
+static void BM_ThreadCachingAllocatorThreads(benchmark::State& state) {
+    static std::vector<char> data;
+    static std::unique_ptr<FreeListAllocator> backing;
+    static std::unique_ptr<ThreadCachingAllocator> allocator;
+    if (state.thread_index() == 0) {
+        allocator.reset();
+        data.resize(4 << 20);
+        backing = std::make_unique<FreeListAllocator>(data.data(), data.size());
+        allocator = std::make_unique<ThreadCachingAllocator>(*backing);
+    }
+    std::array<void*, threadBatch> ptrs{};
+    for (auto _ : state) {
+        for (auto& ptr : ptrs)
+        {
+            ptr = allocator->Allocate(allocationSize, alignment);
+            benchmark::DoNotOptimize(ptr);
+        }
+        for (auto* ptr : ptrs)
+        {
+            allocator->Deallocate(ptr);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * threadBatch);
+}
+BENCHMARK(BM_ThreadCachingAllocatorThreads)->ThreadRange(1, maxThreads)->UseRealTime();
+
+//fragmentation heavy workload: the heap is filled with random sized blocks, one in two is freed,
+//then each iteration frees a random live block and allocates a new one of another size
+static constexpr std::size_t minFragmentSize = 16;
+static constexpr std::size_t maxFragmentSize = 256;
+
+template<typename Allocate, typename Deallocate>
+static void FragmentedWorkload(benchmark::State& state, Allocate allocate, Deallocate deallocate) {
+    const auto liveNum = static_cast<std::size_t>(state.range(0));
+    std::srand(42);
+    auto randomSize = [] { return minFragmentSize + std::rand() % (maxFragmentSize - minFragmentSize); };
+
+    std::vector<void*> all(liveNum * 2);
+    for (auto& ptr : all)
+    {
+        ptr = allocate(randomSize());
+    }
+    std::vector<void*> live;
+    live.reserve(liveNum);
+    for (std::size_t i = 0; i < all.size(); i++)
+    {
+        if (i % 2 == 0)
+            deallocate(all[i]);
+        else
+            live.push_back(all[i]);
+    }
+
+    std::vector<std::size_t> victims(4096);
+    std::vector<std::size_t> sizes(victims.size());
+    for (std::size_t i = 0; i < victims.size(); i++)
+    {
+        victims[i] = std::rand() % live.size();
+        sizes[i] = randomSize();
+    }
+    std::size_t step = 0;
+    for (auto _ : state) {
+        const std::size_t index = victims[step % victims.size()];
+        deallocate(live[index]);
+        live[index] = allocate(sizes[step % sizes.size()]);
+        benchmark::DoNotOptimize(live[index]);
+        step++;
+    }
+    for (auto* ptr : live)
+    {
+        deallocate(ptr);
+    }
+    state.counters["live"] = static_cast<double>(liveNum);
+}
+
+static void BM_MallocFragmented(benchmark::State& state) {
+    FragmentedWorkload(state,
+        [](std::size_t size) { return std::malloc(size); },
+        [](void* ptr) { std::free(ptr); });
+}
+BENCHMARK(BM_MallocFragmented)->Range(64, 16 << 10);
+
+static void BM_FreeListAllocatorFragmented(benchmark::State& state) {
+    //the setup peak is twice the live blocks, plus room for their headers and the fragmentation
+    std::vector<char> data(state.range(0) * 4 * (maxFragmentSize + 32));
+    FreeListAllocator allocator(data.data(), data.size());
+    FragmentedWorkload(state,
+        [&](std::size_t size) { return allocator.Allocate(size, alignment); },
+        [&](void* ptr) { allocator.Deallocate(ptr); });
+}
+BENCHMARK(BM_FreeListAllocatorFragmented)->Range(64, 16 << 10);
+
+static void BM_BuddyAllocatorFragmented(benchmark::State& state) {
+    //every block is rounded to a power of two, twice the room of the free list
+    std::vector<char> data(state.range(0) * 8 * (maxFragmentSize + 32));
+    BuddyAllocator allocator(data.data(), data.size(), minFragmentSize);
+    FragmentedWorkload(state,
+        [&](std::size_t size) { return allocator.Allocate(size, alignment); },
+        [&](void* ptr) { allocator.Deallocate(ptr); });
+}
+BENCHMARK(BM_BuddyAllocatorFragmented)->Range(64, 16 << 10);
+
+static void BM_TlsfAllocatorFragmented(benchmark::State& state) {
+    std::vector<char> data(state.range(0) * 4 * (maxFragmentSize + 32));
+    TlsfAllocator allocator(data.data(), data.size());
+    FragmentedWorkload(state,
+        [&](std::size_t size) { return allocator.Allocate(size, alignment); },
+        [&](void* ptr) { allocator.Deallocate(ptr); });
+}
+BENCHMARK(BM_TlsfAllocatorFragmented)->Range(64, 16 << 10);
+
+//latency of single allocations on a fragmented heap: frame spikes come from the slow calls, not the average.
+//Each iteration times one allocation, the percentiles are reported as counters in nanoseconds
+static constexpr std::size_t latencyLiveNum = 4096;
+static constexpr std::size_t maxLatencySize = 4096;
+
+template<typename Allocate, typename Deallocate>
+static void LatencyWorkload(benchmark::State& state, Allocate allocate, Deallocate deallocate) {
+    std::srand(42);
+    //mostly small blocks and a few big ones, the big ones need a long search in a first fit free list
+    auto randomSize = [] { return std::rand() % 16 == 0 ? 1 + std::rand() % maxLatencySize : minFragmentSize + std::rand() % 112; };
+    std::vector<void*> all(latencyLiveNum * 2);
+    for (auto& ptr : all)
+    {
+        ptr = allocate(randomSize());
+    }
+    std::vector<void*> live;
+    live.reserve(latencyLiveNum);
+    for (std::size_t i = 0; i < all.size(); i++)
+    {
+        if (i % 2 == 0)
+            deallocate(all[i]);
+        else
+            live.push_back(all[i]);
+    }
+
+    std::vector<std::size_t> victims(4096);
+    std::vector<std::size_t> sizes(victims.size());
+    for (std::size_t i = 0; i < victims.size(); i++)
+    {
+        victims[i] = std::rand() % live.size();
+        sizes[i] = randomSize();
+    }
+    std::vector<double> latencies;
+    latencies.reserve(1 << 20);
+    std::size_t step = 0;
+    for (auto _ : state) {
+        const std::size_t index = victims[step % victims.size()];
+        deallocate(live[index]);
+        const auto start = std::chrono::steady_clock::now();
+        live[index] = allocate(sizes[step % sizes.size()]);
+        const auto end = std::chrono::steady_clock::now();
+        benchmark::DoNotOptimize(live[index]);
+        if (latencies.size() < latencies.capacity())
+            latencies.push_back(std::chrono::duration<double, std::nano>(end - start).count());
+        step++;
+    }
+    for (auto* ptr : live)
+    {
+        deallocate(ptr);
+    }
+    if (latencies.empty())
+        return;
+    std::sort(latencies.begin(), latencies.end());
+    auto percentile = [&latencies](double p) { return latencies[static_cast<std::size_t>(p * (latencies.size() - 1))]; };
+    state.counters["p50_ns"] = percentile(0.5);
+    state.counters["p99_ns"] = percentile(0.99);
+    state.counters["p999_ns"] = percentile(0.999);
+    state.counters["max_ns"] = latencies.back();
+}
+
+static void BM_MallocLatency(benchmark::State& state) {
+    LatencyWorkload(state,
+        [](std::size_t size) { return std::malloc(size); },
+        [](void* ptr) { std::free(ptr); });
+}
+BENCHMARK(BM_MallocLatency);
+
+static void BM_FreeListAllocatorLatency(benchmark::State& state) {
+    //little room past the setup peak, the free memory stays scattered between the live blocks
+    std::vector<char> data(latencyLiveNum * 2 * 320);
+    FreeListAllocator allocator(data.data(), data.size());
+    LatencyWorkload(state,
+        [&](std::size_t size) { return allocator.Allocate(size, alignment); },
+        [&](void* ptr) { allocator.Deallocate(ptr); });
+}
+BENCHMARK(BM_FreeListAllocatorLatency);
+
+static void BM_TlsfAllocatorLatency(benchmark::State& state) {
+    //little room past the setup peak, the free memory stays scattered between the live blocks
+    std::vector<char> data(latencyLiveNum * 2 * 320);
+    TlsfAllocator allocator(data.data(), data.size());
+    LatencyWorkload(state,
+        [&](std::size_t size) { return allocator.Allocate(size, alignment); },
+        [&](void* ptr) { allocator.Deallocate(ptr); });
+}
+BENCHMARK(BM_TlsfAllocatorLatency);
@@ -0,0 +1,160 @@
+#include <benchmark/benchmark.h>
+#include <atomic>
+#include <cmath>
+#include <memory>
+
+#include "job_system.h"
+#include "fiber_job_system.h"
+
+const long fromRange = 8;
+
+const long toRange = 1 << 12;
+
+//work done by every job, identical for all the backends
+static constexpr int workPerJob = 1000;
+
+static float Work(uint32_t seed)
+{
+    float result = 0.0f;
+    for (int i = 0; i < workPerJob; i++)
+    {
+        result += std::sqrt(static_cast<float>(seed + i));
+    }
+    return result;
+}
+
+//the pools are started on first use, so a filtered run only starts the backend it measures
+static void InitializeJobSystem()
+{
+    static bool initialized = false;
+    if (!initialized)
+    {
+        JobSystem::Initialize();
+        initialized = true;
+    }
+}
+
+static void InitializeFiberJobSystem()
+{
+    static bool initialized = false;
+    if (!initialized)
+    {
+        FiberJobSystem::Initialize();
+        initialized = true;
+    }
+}
+
+static void BM_01_JobSystemExecute(benchmark::State& state)
+{
+    InitializeJobSystem();
+    const auto jobCount = static_cast<uint32_t>(state.range(0));
+    for (auto _ : state)
+    {
+        std::atomic<float> total{ 0.0f };
+        for (uint32_t i = 0; i < jobCount; i++)
+        {
+            JobSystem::Execute([i, &total] { total.fetch_add(Work(i), std::memory_order_relaxed); });
+        }
+        JobSystem::Wait();
+        benchmark::DoNotOptimize(total.load());
+    }
+    state.SetItemsProcessed(state.iterations() * jobCount);
+}
+BENCHMARK(BM_01_JobSystemExecute)->Range(fromRange, toRange)->UseRealTime();
+
+static void BM_02_JobSystemDispatch(benchmark::State& state)
+{
+    InitializeJobSystem();
+    const auto jobCount = static_cast<uint32_t>(state.range(0));
+    for (auto _ : state)
+    {
+        std::atomic<float> total{ 0.0f };
+        JobSystem::Dispatch(jobCount, 16, [&total](JobDispatchArgs args)
+        {
+            total.fetch_add(Work(args.jobIndex), std::memory_order_relaxed);
+        });
+        JobSystem::Wait();
+        benchmark::DoNotOptimize(total.load());
+    }
+    state.SetItemsProcessed(state.iterations() * jobCount);
+}
+BENCHMARK(BM_02_JobSystemDispatch)->Range(fromRange, toRange)->UseRealTime();
+
+static void BM_03_FiberCoroutine(benchmark::State& state)
+{
+    const auto jobCount = static_cast<uint32_t>(state.range(0));
+    for (auto _ : state)
+    {
+        float total = 0.0f;
+        JobSystem::FiberCoroutine coroutine;
+        coroutine.Setup([jobCount, &total](JobSystem::Coroutine::Yield yield)
+        {
+            for (uint32_t i = 0; i < jobCount; i++)
+            {
+                total += Work(i);
+                yield();
+            }
+        });
+        while (coroutine.Step())
+        {
+        }
+        benchmark::DoNotOptimize(total);
+    }
+    state.SetItemsProcessed(state.iterations() * jobCount);
+}
+BENCHMARK(BM_03_FiberCoroutine)->Range(fromRange, toRange)->UseRealTime();
+
+//what the game loop pays every frame: a new coroutine drawing its fiber from the pool
+static void BM_03_FiberCoroutineCreate(benchmark::State& state)
+{
+    JobSystem::FiberPool::Get().Configure(64 * 1024, 4);
+    for (auto _ : state)
+    {
+        auto coroutine = std::make_shared<JobSystem::FiberCoroutine>();
+        coroutine->Setup([](JobSystem::Coroutine::Yield yield)
+        {
+            yield();
+        });
+        while (coroutine->Step())
+        {
+        }
+    }
+}
+BENCHMARK(BM_03_FiberCoroutineCreate);
+
+//registered last: the work stealing workers poll for work, they would steal cpu time from the benchmarks above
+static void BM_04_FiberJobSystemExecute(benchmark::State& state)
+{
+    InitializeFiberJobSystem();
+    const auto jobCount = static_cast<uint32_t>(state.range(0));
+    for (auto _ : state)
+    {
+        std::atomic<float> total{ 0.0f };
+        for (uint32_t i = 0; i < jobCount; i++)
+        {
+            FiberJobSystem::Execute([i, &total] { total.fetch_add(Work(i), std::memory_order_relaxed); });
+        }
+        FiberJobSystem::Wait();
+        benchmark::DoNotOptimize(total.load());
+    }
+    state.SetItemsProcessed(state.iterations() * jobCount);
+}
+BENCHMARK(BM_04_FiberJobSystemExecute)->Range(fromRange, toRange)->UseRealTime();
+
+static void BM_05_FiberJobSystemDispatch(benchmark::State& state)
+{
+    InitializeFiberJobSystem();
+    const auto jobCount = static_cast<uint32_t>(state.range(0));
+    for (auto _ : state)
+    {
+        std::atomic<float> total{ 0.0f };
+        FiberJobSystem::Dispatch(jobCount, 16, [&total](JobDispatchArgs args)
+        {
+            total.fetch_add(Work(args.jobIndex), std::memory_order_relaxed);
+        });
+        FiberJobSystem::Wait();
+        benchmark::DoNotOptimize(total.load());
+    }
+    state.SetItemsProcessed(state.iterations() * jobCount);
+}
+BENCHMARK(BM_05_FiberJobSystemDispatch)->Range(fromRange, toRange)->UseRealTime();
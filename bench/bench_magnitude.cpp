@@ -6,6 +6,7 @@
 #include <benchmark/benchmark.h>
 #include <vector>
 #include <random>
+#include "aligned_vector.h"
 #include "vector3.h"
 #include "bench_utils.h"
 
@@ -56,4 +57,40 @@ static void BM_MagnitudeAoSoA8(benchmark::State& state)
 }
 BENCHMARK(BM_MagnitudeAoSoA8)->Range(fromRange, toRange);
 
+#if defined(__AVX__)
+//plain SoA arrays in AlignedVector, the padding of the storage lets the last register be processed whole
+static void BM_MagnitudeSoAAligned(benchmark::State& state)
+{
+    const std::size_t count = state.range(0);
+    AlignedVector<float> xs(count), ys(count), zs(count), magnitudes(count);
+    std::vector<maths::Vec3f> v1(count);
+    std::ranges::for_each(v1, [](maths::Vec3f& v) { FillRandom(v); });
+    for (std::size_t i = 0; i < count; i++)
+    {
+        xs[i] = v1[i].x;
+        ys[i] = v1[i].y;
+        zs[i] = v1[i].z;
+    }
+    constexpr std::size_t lanes = LaneCount<float>();
+    for (auto _ : state)
+    {
+        for (std::size_t i = 0; i < count; i += lanes)
+        {
+            auto x = _mm256_load_ps(xs.data() + i);
+            auto y = _mm256_load_ps(ys.data() + i);
+            auto z = _mm256_load_ps(zs.data() + i);
+            x = _mm256_mul_ps(x, x);
+            y = _mm256_mul_ps(y, y);
+            z = _mm256_mul_ps(z, z);
+            x = _mm256_add_ps(x, y);
+            x = _mm256_add_ps(x, z);
+            _mm256_store_ps(magnitudes.data() + i, _mm256_sqrt_ps(x));
+        }
+        benchmark::DoNotOptimize(magnitudes.data());
+        benchmark::ClobberMemory();
+    }
+}
+BENCHMARK(BM_MagnitudeSoAAligned)->Range(fromRange, toRange);
+#endif
+
 BENCHMARK_MAIN ();
\ No newline at end of file
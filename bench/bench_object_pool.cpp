@@ -0,0 +1,108 @@
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "object_pool.h"
+
+const long fromRange = 64;
+const long toRange = 1 << 16;
+
+//a game object, big enough that scattered heap copies miss the cache
+struct Particle
+{
+    float position[3]{};
+    float velocity[3]{1.0f, 2.0f, 3.0f};
+    char payload[40]{};
+};
+
+//each object allocated on its own, then shuffled like objects created and destroyed over time
+static void BM_UpdateHeapObjects(benchmark::State& state) {
+    const auto count = state.range(0);
+    std::vector<std::unique_ptr<Particle>> particles;
+    std::vector<std::unique_ptr<Particle>> garbage;
+    for (long i = 0; i < count; i++)
+    {
+        particles.push_back(std::make_unique<Particle>());
+        //interleave other allocations so the particles don't end up next to each other
+        garbage.push_back(std::make_unique<Particle>());
+    }
+    std::shuffle(particles.begin(), particles.end(), std::mt19937(42));
+    for (auto _ : state) {
+        for (auto& particle : particles)
+        {
+            for (int axis = 0; axis < 3; axis++)
+            {
+                particle->position[axis] += particle->velocity[axis];
+            }
+        }
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK(BM_UpdateHeapObjects)->Range(fromRange, toRange);
+
+static void BM_UpdateObjectPool(benchmark::State& state) {
+    const auto count = state.range(0);
+    ObjectPool<Particle> particles;
+    std::vector<PoolHandle> handles;
+    for (long i = 0; i < count * 2; i++)
+    {
+        handles.push_back(particles.Create());
+    }
+    //destroy half of them in random order, the pool stays packed
+    std::shuffle(handles.begin(), handles.end(), std::mt19937(42));
+    for (long i = 0; i < count; i++)
+    {
+        particles.Destroy(handles[i]);
+    }
+    for (auto _ : state) {
+        particles.ForEach([](Particle& particle)
+        {
+            for (int axis = 0; axis < 3; axis++)
+            {
+                particle.position[axis] += particle.velocity[axis];
+            }
+        });
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK(BM_UpdateObjectPool)->Range(fromRange, toRange);
+
+static void BM_CreateDestroyHeap(benchmark::State& state) {
+    std::vector<std::unique_ptr<Particle>> particles(state.range(0));
+    for (auto _ : state) {
+        for (auto& particle : particles)
+        {
+            particle = std::make_unique<Particle>();
+        }
+        for (auto& particle : particles)
+        {
+            particle.reset();
+        }
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_CreateDestroyHeap)->Range(fromRange, toRange);
+
+static void BM_CreateDestroyObjectPool(benchmark::State& state) {
+    ObjectPool<Particle> particles;
+    particles.Reserve(state.range(0));
+    std::vector<PoolHandle> handles(state.range(0));
+    for (auto _ : state) {
+        for (auto& handle : handles)
+        {
+            handle = particles.Create();
+        }
+        for (auto handle : handles)
+        {
+            particles.Destroy(handle);
+        }
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_CreateDestroyObjectPool)->Range(fromRange, toRange);
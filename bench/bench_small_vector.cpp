@@ -0,0 +1,104 @@
+#include <benchmark/benchmark.h>
+#include "small_vector.h"
+
+#include <cstdint>
+#include <vector>
+
+//short lists built and thrown away, like the buildings overlapping an entity or the dependents of a job
+constexpr long fromRange = 1;
+constexpr long toRange = 64;
+//SmallVector spills to the heap past 16 elements
+constexpr std::size_t inlineCount = 16;
+
+template<typename Container>
+static void BuildList(Container& list, std::int64_t length)
+{
+    for (std::int64_t i = 0; i < length; i++)
+    {
+        list.push_back(static_cast<int>(i));
+    }
+}
+
+template<typename Container>
+static int SumList(const Container& list)
+{
+    int sum = 0;
+    for (int value : list)
+    {
+        sum += value;
+    }
+    return sum;
+}
+
+static void BM_StdVector(benchmark::State& state)
+{
+    for (auto _ : state)
+    {
+        std::vector<int> list;
+        BuildList(list, state.range(0));
+        benchmark::DoNotOptimize(SumList(list));
+    }
+}
+BENCHMARK(BM_StdVector)->RangeMultiplier(2)->Range(fromRange, toRange);
+
+//one allocation per list
+static void BM_StdVectorReserve(benchmark::State& state)
+{
+    for (auto _ : state)
+    {
+        std::vector<int> list;
+        list.reserve(state.range(0));
+        BuildList(list, state.range(0));
+        benchmark::DoNotOptimize(SumList(list));
+    }
+}
+BENCHMARK(BM_StdVectorReserve)->RangeMultiplier(2)->Range(fromRange, toRange);
+
+//a list kept by its owner and cleared, the steady state of a reused std::vector
+static void BM_StdVectorReuse(benchmark::State& state)
+{
+    std::vector<int> list;
+    for (auto _ : state)
+    {
+        list.clear();
+        BuildList(list, state.range(0));
+        benchmark::DoNotOptimize(SumList(list));
+    }
+}
+BENCHMARK(BM_StdVectorReuse)->RangeMultiplier(2)->Range(fromRange, toRange);
+
+static void BM_SmallVector(benchmark::State& state)
+{
+    for (auto _ : state)
+    {
+        SmallVector<int, inlineCount> list;
+        BuildList(list, state.range(0));
+        benchmark::DoNotOptimize(SumList(list));
+    }
+}
+BENCHMARK(BM_SmallVector)->RangeMultiplier(2)->Range(fromRange, toRange);
+
+static void BM_SmallVectorReserve(benchmark::State& state)
+{
+    for (auto _ : state)
+    {
+        SmallVector<int, inlineCount> list;
+        list.reserve(state.range(0));
+        BuildList(list, state.range(0));
+        benchmark::DoNotOptimize(SumList(list));
+    }
+}
+BENCHMARK(BM_SmallVectorReserve)->RangeMultiplier(2)->Range(fromRange, toRange);
+
+static void BM_InplaceVector(benchmark::State& state)
+{
+    for (auto _ : state)
+    {
+        InplaceVector<int, toRange> list;
+        BuildList(list, state.range(0));
+        benchmark::DoNotOptimize(SumList(list));
+    }
+}
+BENCHMARK(BM_InplaceVector)->RangeMultiplier(2)->Range(fromRange, toRange);
+
+BENCHMARK_MAIN();
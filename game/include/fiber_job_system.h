@@ -0,0 +1,34 @@
+#pragma once
+#include <functional>
+
+#include "job_system.h"
+
+//Same interface as JobSystem, but every job is a boost::fiber scheduled with the work stealing algorithm.
+//Wait() suspends the calling fiber instead of blocking its thread, the thread keeps running the jobs meanwhile.
+namespace FiberJobSystem
+{
+	//initialyze fiber job system, the calling thread joins the work stealing pool
+	//must be called once, from the thread that will Execute/Dispatch/Wait
+	//stackSize : size of every fiber stack, stackCount : how many stacks are pooled (see StackPool)
+	void Initialize(std::size_t stackSize = 64 * 1024, std::size_t stackCount = 256);
+
+	//add a job to execute asynchronously as a new fiber, any worker thread can steal it
+	//name, color : optional name and color of the job zone in tracy, name must outlive the job
+	//with TRACY_FIBERS every job is its own tracy fiber, its zones stay correct when it resumes on another thread
+	void Execute(const std::function<void()>& job, const char* name = nullptr, uint32_t color = 0);
+
+	//Divide job into multiple fibers.
+	//jobcount : how many jobs generate for this task
+	//groupeSize : how many job to execute per fiber. Job inside a groupe execute serially.
+	//func : receives a JobdispatcherArgs as parameter
+	//name, color : optional name and color of the job zones in tracy
+	void Dispatch(uint32_t jobCount, uint32_t groupSize, const std::function<void(JobDispatchArgs)>& job,
+		const char* name = nullptr, uint32_t color = 0);
+
+	//check if fibers are still running or not
+	bool IsBusy();
+
+	//Wait until all fibers are finished, the calling fiber is suspended so the thread keeps working
+	//Must not be called from a job: the count includes the calling job, it would never reach zero
+	void Wait();
+}
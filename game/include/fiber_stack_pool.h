@@ -0,0 +1,41 @@
+#pragma once
+#include <cstddef>
+#include <mutex>
+#include <vector>
+
+namespace JobSystem
+{
+	//Fixed set of fiber stacks mapped once and reused.
+	//Every stack has a no access guard page under it (stacks grow down), an overflow crash instead of
+	//silently writing over the neighbour stack.
+	class StackPool
+	{
+	public:
+		//stackSize : usable size of one stack, rounded up to the page size
+		//stackCount : how many stacks are mapped up front
+		StackPool(std::size_t stackSize, std::size_t stackCount);
+		~StackPool();
+
+		StackPool(const StackPool&) = delete;
+		StackPool& operator=(const StackPool&) = delete;
+
+		//Returns the lowest usable address of a stack
+		//When the pool is empty a new stack is mapped, it is unmapped instead of pooled on Release
+		void* Acquire();
+
+		void Release(void* stack);
+
+		[[nodiscard]] std::size_t GetStackSize() const { return stackSize_; }
+		[[nodiscard]] std::size_t GetPageSize() const { return pageSize_; }
+
+	private:
+		bool Owns(const void* stack) const;
+
+		std::size_t pageSize_ = 0;
+		std::size_t stackSize_ = 0;
+		std::size_t stackCount_ = 0;
+		char* region_ = nullptr;
+		std::mutex lock_;
+		std::vector<void*> freeStacks_;
+	};
+}
@@ -1,9 +1,24 @@
 #pragma once
+#include <chrono>
 #include <functional>
+#include <memory>
 #include <mutex>
 #include <optional>
+#include <vector>
 
 #include "entity.h"
+#include "ring_buffer.h"
+
+#include <tracy/Tracy.hpp>
+
+//coroutine switches show up as fibers in tracy, nothing when tracy or its fiber support is off
+#if defined(TRACY_ENABLE) && defined(TRACY_FIBERS)
+#define JOB_FIBER_ENTER(name) TracyFiberEnter(name)
+#define JOB_FIBER_LEAVE TracyFiberLeave
+#else
+#define JOB_FIBER_ENTER(name)
+#define JOB_FIBER_LEAVE
+#endif
 
 //job receive a function argument
 struct JobDispatchArgs
@@ -18,13 +33,16 @@ namespace JobSystem
 	void Initialize();
 
 	//add a job to execute asynchronously, any ide thread execute
-	void Execute(const std::function<void()>& job);
+	//name, color : optional name and color of the job zone in tracy, name must outlive the job
+	void Execute(const std::function<void()>& job, const char* name = nullptr, uint32_t color = 0);
 
 	//Divide job into multiple in parallel.
 	//jobcount : how many jobs generate for this task
 	//groupeSize : how many job to execute per thread. Job inside a groupe execute serially. It might be worth to increment
 	//func : receives a JobdispatcherArgs as parameter
-	void Dispatch(uint32_t jobCount, uint32_t groupSize, const std::function<void(JobDispatchArgs)>& job);
+	//name, color : optional name and color of the job zones in tracy
+	void Dispatch(uint32_t jobCount, uint32_t groupSize, const std::function<void(JobDispatchArgs)>& job,
+		const char* name = nullptr, uint32_t color = 0);
 
 	//check if threads are wokinng currently or not
 	bool IsBusy();
@@ -35,52 +53,6 @@ namespace JobSystem
 	// This little helper function will not let the system to be deadlocked while the main thread is waiting for something
 	void Pool();
 
-	template <typename T,size_t capacity>
-	class ThreadSafeRingBuffer
-	{
-	public:
-		//	Push an item to the end if there is free space
-		//  Returns true if succesful
-		//  Returns false if there is not enough space
-		inline bool push_back(const T& item)
-		{
-			bool result = false;
-			lock.lock();
-			size_t next = (head + 1) % capacity;
-			if (next != tail)
-			{
-				data[head] = item;
-				head = next;
-				result = true;
-			}
-			lock.unlock();
-			return result;
-		}
-
-		// Get an item if there are any
-		//  Returns true if succesful
-		//  Returns false if there are no items
-		inline bool pop_front(T& item)
-		{
-			bool result = false;
-			lock.lock();
-			if (tail != head)
-			{
-				item = data[tail];
-				tail = (tail + 1) % capacity;
-				result = true;
- 			}
-			lock.unlock();
-			return result;
-		}
-
-	private:
-		std::mutex lock;
-		size_t tail = 0;
-		size_t head = 0;
-		T data[capacity];
-	};
-
 	class Coroutine
 	{
 	public:
@@ -94,15 +66,53 @@ namespace JobSystem
 		virtual bool Step() = 0; 
 	};
 
-	class FiberCoroutine : Coroutine
+	class FiberCoroutine;
+
+	//win32 fiber kept alive between coroutines, its start routine loops over the coroutines it is lent to
+	struct PooledFiber
+	{
+		LPVOID handle = nullptr;
+		FiberCoroutine* owner = nullptr;
+	};
+
+	//Fixed set of fibers reused by FiberCoroutine, CreateFiber reserve and commit a new stack every call.
+	//Win32 fibers allocate their own stack (with its guard page), the pool keeps the fibers instead.
+	class FiberPool
+	{
+	public:
+		static FiberPool& Get();
+
+		//stackSize : stack reserved for every fiber, capacity : how many fibers are kept for reuse
+		//the fibers are created immediately
+		void Configure(std::size_t stackSize, std::size_t capacity);
+
+		//a fiber from the pool, a new one if the pool is empty
+		PooledFiber* Acquire();
+
+		//finished : the coroutine function returned, a fiber stopped in the middle of it can't be reused
+		void Release(PooledFiber* fiber, bool finished);
+
+	private:
+		//stackSize : read under the lock by the caller
+		PooledFiber* Create(std::size_t stackSize);
+		static VOID WINAPI Proc(LPVOID data);
+
+		std::mutex lock_;
+		std::vector<PooledFiber*> freeFibers_;
+		std::size_t stackSize_ = 64 * 1024;
+		std::size_t capacity_ = 16;
+	};
+
+	class FiberCoroutine : public Coroutine
 	{
 	public:
-		FiberCoroutine() : mCurrent(nullptr), mRunning(false) {}
+		//name : fiber name in tracy, must outlive the coroutine
+		FiberCoroutine(const char* name = "Coroutine") : mCurrent(nullptr), mRunning(false), mName(name) {}
 
 		~FiberCoroutine() override
 		{
 			if (mCurrent)
-				DeleteFiber(mCurrent);
+				FiberPool::Get().Release(mCurrent, !mRunning);
 		}
 
 		void Setup(Run f) override
@@ -116,14 +126,16 @@ namespace JobSystem
 
 			if (!mCurrent)
 			{
-				mCurrent = CreateFiber(0,
-					&FiberCoroutine::proc, this);
+				mCurrent = FiberPool::Get().Acquire();
+				mCurrent->owner = this;
 			}
 		}
 
 		bool Step() override
 		{
-			SwitchToFiber(mCurrent);
+			JOB_FIBER_ENTER(mName);
+			SwitchToFiber(mCurrent->handle);
+			JOB_FIBER_LEAVE;
 			//return mRunning;
 			return mRunning;
 		}
@@ -134,28 +146,50 @@ namespace JobSystem
 		}
 
 	private:
+		friend class FiberPool;
 
+		//one run of the coroutine function, the pooled fiber calls it again for its next owner
 		void run()
 		{
-			while (true)
-			{
-				mFunction([this]
-					{ yield(); });
-				mRunning = false;
-				yield();
-			}
-		}
-
-		static VOID WINAPI proc(LPVOID data)
-		{
-			reinterpret_cast<FiberCoroutine*>(data)->run();
+			mFunction([this]
+				{ yield(); });
+			mRunning = false;
+			yield();
 		}
 
-		inline static LPVOID mMain = nullptr;
-		LPVOID mCurrent;
+		inline static thread_local LPVOID mMain = nullptr;
+		PooledFiber* mCurrent;
 		bool mRunning;
+		const char* mName;
 		Run mFunction;
 	};
-	
-	
+
+	//Resume long coroutines a slice at a time, only while the frame still has time left.
+	//The jobs call yield at their checkpoints, the scheduler decides if one more slice fits in the frame.
+	//Coroutines are win32 fibers: Add and Update must be called from the same thread.
+	class FrameScheduler
+	{
+	public:
+		using Clock = std::chrono::steady_clock;
+
+		//frameBudget : target duration of a frame
+		//minRemaining : no slice is started when less than this is left in the frame
+		FrameScheduler(Clock::duration frameBudget, Clock::duration minRemaining);
+
+		//add a long job, it starts at the next Update
+		//name : fiber name of the job in tracy, must outlive the job
+		void Add(Coroutine::Run job, const char* name = "Long job");
+
+		//frameElapsed : time already spent in this frame, read from the frame clock
+		//steps the jobs round robin until the remaining frame time drops under minRemaining
+		void Update(Clock::duration frameElapsed);
+
+		[[nodiscard]] std::size_t GetPendingCount() const { return jobs_.size(); }
+
+	private:
+		Clock::duration frameBudget_;
+		Clock::duration minRemaining_;
+		std::vector<std::unique_ptr<FiberCoroutine>> jobs_;
+		std::size_t nextJob_ = 0;
+	};
 }
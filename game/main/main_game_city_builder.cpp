@@ -9,8 +9,10 @@
 	{
 		ZoneScopedN("test");
 		JobSystem::Initialize();
+		//the game loop creates a coroutine every frame, keep its fibers around
+		JobSystem::FiberPool::Get().Configure(64 * 1024, 4);
 		CityBuilderGame::window_game window;
-		JobSystem::Execute([&] {window.Create_Window("CItyBuilderGame"); });
+		JobSystem::Execute([&] {window.Create_Window("CItyBuilderGame"); }, "Game window");
 		JobSystem::Wait();
 		/*window.Create_Window("CityBuilderGame");*/
 		return EXIT_SUCCESS;
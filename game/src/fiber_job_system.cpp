@@ -0,0 +1,295 @@
+#include "fiber_job_system.h"
+#include <algorithm>
+#include <cassert>
+#include <atomic>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "fiber_stack_pool.h"
+
+#include <boost/fiber/all.hpp>
+#include <boost/fiber/algo/work_stealing.hpp>
+
+namespace FiberJobSystem
+{
+	uint32_t numThreads = 0;
+	std::atomic<uint64_t> pendingJobs{ 0 };
+	boost::fibers::mutex waitMutex;
+	boost::fibers::condition_variable waitCondition;
+	std::unique_ptr<JobSystem::StackPool> stackPool;
+	//set in the fibers running a job, follows the fiber when another thread steals it
+	//the pointer is never owned, the cleanup does nothing
+	bool jobMarker = true;
+	boost::fibers::fiber_specific_ptr<bool> jobFiber([](bool*) {});
+
+	//boost StackAllocator drawing the fiber stacks from the pool instead of mapping a new one per fiber
+	//every fiber keeps its own copy of the allocator, it remembers where its stack came from
+	class PooledStackAllocator
+	{
+	public:
+		boost::context::stack_context allocate()
+		{
+			void* stack = stackPool->Acquire();
+			if (stack == nullptr)
+			{
+				//the pool could not map a new stack, a heap stack without guard page still runs the job
+				usesFallback_ = true;
+				return fallback_.allocate();
+			}
+			boost::context::stack_context context;
+			context.size = stackPool->GetStackSize();
+			context.sp = static_cast<char*>(stack) + context.size;
+			return context;
+		}
+
+		void deallocate(boost::context::stack_context& context)
+		{
+			if (usesFallback_)
+			{
+				fallback_.deallocate(context);
+				return;
+			}
+			stackPool->Release(static_cast<char*>(context.sp) - context.size);
+		}
+
+	private:
+		boost::context::fixedsize_stack fallback_{ stackPool->GetStackSize() };
+		bool usesFallback_ = false;
+	};
+
+#if defined(TRACY_ENABLE) && defined(TRACY_FIBERS)
+	//the tracy fiber of the job a boost fiber runs, read by the scheduler on every switch
+	struct JobFiberProperties : public boost::fibers::fiber_properties
+	{
+		using fiber_properties::fiber_properties;
+
+		const char* tracyFiber = nullptr;
+	};
+
+	//tracy tells the fibers apart by name, every job running at the same time needs its own
+	//the names are reused but never freed, tracy reads them until the end of the capture
+	std::mutex tracyFiberLock;
+	std::deque<std::string> tracyFiberNames;
+	std::vector<const char*> freeTracyFibers;
+
+	//the tracy fiber this thread is in, nullptr outside of the jobs
+	thread_local const char* currentTracyFiber = nullptr;
+
+	const char* AcquireTracyFiber()
+	{
+		std::lock_guard<std::mutex> lock(tracyFiberLock);
+		if (!freeTracyFibers.empty())
+		{
+			const char* name = freeTracyFibers.back();
+			freeTracyFibers.pop_back();
+			return name;
+		}
+		tracyFiberNames.push_back("Fiber job " + std::to_string(tracyFiberNames.size()));
+		return tracyFiberNames.back().c_str();
+	}
+
+	void ReleaseTracyFiber(const char* name)
+	{
+		std::lock_guard<std::mutex> lock(tracyFiberLock);
+		freeTracyFibers.push_back(name);
+	}
+
+	void SwitchTracyFiber(const char* name)
+	{
+		if (name == currentTracyFiber)
+		{
+			return;
+		}
+		if (currentTracyFiber)
+		{
+			JOB_FIBER_LEAVE;
+		}
+		if (name)
+		{
+			JOB_FIBER_ENTER(name);
+		}
+		currentTracyFiber = name;
+	}
+
+	//work stealing reporting the fiber switches to tracy
+	//a job suspended on one thread can resume on another, its zones follow it in its tracy fiber
+	class TracedWorkStealing : public boost::fibers::algo::algorithm_with_properties<JobFiberProperties>
+	{
+	public:
+		explicit TracedWorkStealing(uint32_t threadCount) :
+			scheduler_(new boost::fibers::algo::work_stealing(threadCount))
+		{
+		}
+
+		void awakened(boost::fibers::context* context, JobFiberProperties&) noexcept override
+		{
+			scheduler_->awakened(context);
+		}
+
+		//called on the thread about to switch, right before it resumes the fiber returned
+		boost::fibers::context* pick_next() noexcept override
+		{
+			boost::fibers::context* next = scheduler_->pick_next();
+			//nullptr : the thread goes back to its dispatcher fiber, not a job
+			const boost::fibers::fiber_properties* nextProperties = next ? get_properties(next) : nullptr;
+			SwitchTracyFiber(nextProperties ? static_cast<const JobFiberProperties*>(nextProperties)->tracyFiber : nullptr);
+			return next;
+		}
+
+		bool has_ready_fibers() const noexcept override
+		{
+			return scheduler_->has_ready_fibers();
+		}
+
+		void suspend_until(const std::chrono::steady_clock::time_point& time) noexcept override
+		{
+			scheduler_->suspend_until(time);
+		}
+
+		void notify() noexcept override
+		{
+			scheduler_->notify();
+		}
+
+	private:
+		//work_stealing registers itself in a shared list of schedulers, it must live on the heap
+		boost::intrusive_ptr<boost::fibers::algo::work_stealing> scheduler_;
+	};
+
+	using SchedulingAlgorithm = TracedWorkStealing;
+#else
+	using SchedulingAlgorithm = boost::fibers::algo::work_stealing;
+#endif
+
+	//a job is finished, wake the fibers waiting on the last one
+	void FinishJob()
+	{
+		if (pendingJobs.fetch_sub(1) == 1)
+		{
+			std::unique_lock<boost::fibers::mutex> lock(waitMutex);
+			waitCondition.notify_all();
+		}
+	}
+
+	//body of every job fiber: a tracy fiber and a zone named like the JobSystem ones
+	template<typename Job>
+	void RunJob(const Job& job, const char* name, uint32_t color)
+	{
+		jobFiber.reset(&jobMarker);
+#if defined(TRACY_ENABLE) && defined(TRACY_FIBERS)
+		JobFiberProperties& properties = boost::this_fiber::properties<JobFiberProperties>();
+		properties.tracyFiber = AcquireTracyFiber();
+		SwitchTracyFiber(properties.tracyFiber);
+#endif
+		{
+			ZoneScopedN("Job");
+			if (name)
+			{
+				ZoneName(name, std::strlen(name));
+			}
+			if (color)
+			{
+				ZoneColor(color);
+			}
+			job();
+		}
+#if defined(TRACY_ENABLE) && defined(TRACY_FIBERS)
+		SwitchTracyFiber(nullptr);
+		ReleaseTracyFiber(properties.tracyFiber);
+		properties.tracyFiber = nullptr;
+#endif
+		FinishJob();
+	}
+
+	void Initialize(std::size_t stackSize, std::size_t stackCount)
+	{
+		stackPool = std::make_unique<JobSystem::StackPool>(stackSize, stackCount);
+
+		// Retrieve the number of hardware threads in this system:
+		auto numCores = std::thread::hardware_concurrency();
+
+		//the calling thread is part of the pool, the other cores become workers
+		numThreads = std::max(1u, numCores);
+
+		for (uint32_t threadId = 1; threadId < numThreads; ++threadId)
+		{
+			std::thread worker([]()
+			{
+				// register the thread in the work stealing pool, blocks until every thread registered
+				// suspend stays false: a sleeping scheduler is only woken by its own queue, so it would never steal again
+				boost::fibers::use_scheduling_algorithm<SchedulingAlgorithm>(numThreads);
+
+				// the main fiber of the worker sleeps forever, the scheduler runs the stolen fibers meanwhile
+				boost::fibers::mutex idleMutex;
+				boost::fibers::condition_variable idleCondition;
+				std::unique_lock<boost::fibers::mutex> lock(idleMutex);
+				idleCondition.wait(lock, []() { return false; });
+			});
+
+			worker.detach(); // forget about this thread, like JobSystem workers
+		}
+		boost::fibers::use_scheduling_algorithm<SchedulingAlgorithm>(numThreads);
+	}
+
+	void Execute(const std::function<void()>& job, const char* name, uint32_t color)
+	{
+		pendingJobs.fetch_add(1);
+		boost::fibers::fiber(std::allocator_arg, PooledStackAllocator(), [job, name, color]()
+		{
+			RunJob(job, name, color);
+		}).detach();
+	}
+
+	void Dispatch(uint32_t jobCount, uint32_t groupSize, const std::function<void(JobDispatchArgs)>& job,
+		const char* name, uint32_t color)
+	{
+		if (jobCount == 0 || groupSize == 0)
+		{
+			return;
+		}
+		// Calculate the amount of job groups to dispatch (overestimate, or "ceil"):
+		const uint32_t groupCount = (jobCount + groupSize - 1) / groupSize;
+
+		pendingJobs.fetch_add(groupCount);
+
+		for (uint32_t groupIndex = 0; groupIndex < groupCount; ++groupIndex)
+		{
+			// For each group, launch one fiber:
+			boost::fibers::fiber(std::allocator_arg, PooledStackAllocator(), [jobCount, groupSize, job, groupIndex, name, color]()
+			{
+				RunJob([jobCount, groupSize, &job, groupIndex]()
+				{
+					const uint32_t groupJobOffset = groupIndex * groupSize;
+					const uint32_t groupJobEnd = std::min(groupJobOffset + groupSize, jobCount);
+
+					JobDispatchArgs args;
+					args.groupIndex = groupIndex;
+
+					for (uint32_t i = groupJobOffset; i < groupJobEnd; ++i)
+					{
+						args.jobIndex = i;
+						job(args);
+					}
+				}, name, color);
+			}).detach();
+		}
+	}
+
+	bool IsBusy()
+	{
+		return pendingJobs.load() > 0;
+	}
+
+	void Wait()
+	{
+		assert(jobFiber.get() == nullptr && "FiberJobSystem::Wait called from a job, it would wait for itself");
+		// fiber aware join: only the calling fiber is suspended, its thread keeps executing jobs
+		std::unique_lock<boost::fibers::mutex> lock(waitMutex);
+		waitCondition.wait(lock, []() { return pendingJobs.load() == 0; });
+	}
+}
@@ -0,0 +1,129 @@
+#include "fiber_stack_pool.h"
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace JobSystem
+{
+	namespace
+	{
+		std::size_t QueryPageSize()
+		{
+#ifdef _WIN32
+			SYSTEM_INFO info;
+			GetSystemInfo(&info);
+			return info.dwPageSize;
+#else
+			return static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+#endif
+		}
+
+		//map size bytes, the first guardSize bytes stay inaccessible
+		char* MapWithGuard(std::size_t size, std::size_t guardSize)
+		{
+#ifdef _WIN32
+			auto* region = static_cast<char*>(VirtualAlloc(nullptr, size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE));
+			if (region == nullptr)
+			{
+				return nullptr;
+			}
+			DWORD oldProtect;
+			VirtualProtect(region, guardSize, PAGE_NOACCESS, &oldProtect);
+			return region;
+#else
+			void* region = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_STACK, -1, 0);
+			if (region == MAP_FAILED)
+			{
+				return nullptr;
+			}
+			mprotect(region, guardSize, PROT_NONE);
+			return static_cast<char*>(region);
+#endif
+		}
+
+		void Unmap(void* region, std::size_t size)
+		{
+#ifdef _WIN32
+			VirtualFree(region, 0, MEM_RELEASE);
+#else
+			munmap(region, size);
+#endif
+		}
+	}
+
+	StackPool::StackPool(std::size_t stackSize, std::size_t stackCount) :
+		pageSize_(QueryPageSize()),
+		stackCount_(stackCount)
+	{
+		stackSize_ = (stackSize + pageSize_ - 1) / pageSize_ * pageSize_;
+		const std::size_t slotSize = stackSize_ + pageSize_;
+
+		// one mapping for all the stacks, the guard pages are protected one by one
+		region_ = MapWithGuard(slotSize * stackCount_, pageSize_);
+		if (region_ == nullptr)
+		{
+			stackCount_ = 0;
+			return;
+		}
+		freeStacks_.reserve(stackCount_);
+		for (std::size_t i = 0; i < stackCount_; i++)
+		{
+			char* slot = region_ + i * slotSize;
+			if (i > 0)
+			{
+#ifdef _WIN32
+				DWORD oldProtect;
+				VirtualProtect(slot, pageSize_, PAGE_NOACCESS, &oldProtect);
+#else
+				mprotect(slot, pageSize_, PROT_NONE);
+#endif
+			}
+			freeStacks_.push_back(slot + pageSize_);
+		}
+	}
+
+	StackPool::~StackPool()
+	{
+		if (region_ != nullptr)
+		{
+			Unmap(region_, (stackSize_ + pageSize_) * stackCount_);
+		}
+	}
+
+	void* StackPool::Acquire()
+	{
+		{
+			std::lock_guard<std::mutex> lock(lock_);
+			if (!freeStacks_.empty())
+			{
+				void* stack = freeStacks_.back();
+				freeStacks_.pop_back();
+				return stack;
+			}
+		}
+		// pool exhausted, map a stand alone stack
+		char* region = MapWithGuard(stackSize_ + pageSize_, pageSize_);
+		return region == nullptr ? nullptr : region + pageSize_;
+	}
+
+	void StackPool::Release(void* stack)
+	{
+		if (!Owns(stack))
+		{
+			Unmap(static_cast<char*>(stack) - pageSize_, stackSize_ + pageSize_);
+			return;
+		}
+		std::lock_guard<std::mutex> lock(lock_);
+		freeStacks_.push_back(stack);
+	}
+
+	bool StackPool::Owns(const void* stack) const
+	{
+		const auto* ptr = static_cast<const char*>(stack);
+		return region_ != nullptr && ptr >= region_ && ptr < region_ + (stackSize_ + pageSize_) * stackCount_;
+	}
+}
@@ -4,7 +4,13 @@
 #include "game_global.h"
 #include "entity.h"
 #include "job_system.h"
+#include "epoch_reclamation.h"
+#include "allocator_resource.h"
 #include "Windows.h"
+#include <cmath>
+#ifdef ALLOCATION_TRACKER
+#include "allocation_tracker.h"
+#endif
 
 #ifdef TRACY_ENABLE
 #include <tracy/Tracy.hpp>
@@ -41,12 +47,28 @@ namespace CityBuilderGame
 		_entity.Init();
 		//start game loop
 		sf::Clock _deltaClock;
+		//long jobs (pathfinding rebuild, autosave...) resumed with the time left in each 60 fps frame
+		JobSystem::FrameScheduler _longJobs(std::chrono::microseconds(16667), std::chrono::milliseconds(2));
+		//progress of the economy forecast long job, written by the job between two checkpoints
+		int _forecastDay = 0;
+		float _forecastMoney = 0.0f;
+		sf::Clock _frameClock;
+		//transient data of a frame (coroutines, copies given to the render...), valid until the end of the next frame
+		std::vector<char> _frameMemory(2 * 1024 * 1024);
+		DoubleFrameAllocator _frameAllocator(_frameMemory.data(), _frameMemory.size());
+		_frameAllocator.SetName("Frame allocator");
+		AllocatorResource _frameResource(_frameAllocator);
+#ifdef ALLOCATION_TRACKER
+		//heap allocations of the previous frame, the goal is none in the game loop
+		AllocationTracker::Report _allocationReport;
+#endif
 		
 		while (_GameWindow.isOpen())
 		{
 #ifdef TRACY_ENABLE
 			ZoneScopedN("Game Loop");
 #endif
+			_frameClock.restart();
 			sf::Event event;
 			while (_GameWindow.pollEvent(event))
 			{
@@ -84,6 +106,63 @@ namespace CityBuilderGame
 			//imguisfmlcreate
 			ImGui::Text("Money = %f", moneyGlob);
 
+			ImGui::Text("Frame memory = %zu / %zu bytes (peak %zu)", _frameAllocator.GetLastFrameUsedMemory(),
+				_frameAllocator.GetFrameCapacity(), _frameAllocator.GetPeakFrameUsedMemory());
+#ifdef ALLOCATION_TRACKER
+			//trace for allocation_replay, written in the working directory
+			bool recordAllocations = AllocationTracker::Get().IsRecording();
+			if (ImGui::Checkbox("Record allocations", &recordAllocations))
+			{
+				if (recordAllocations)
+				{
+					AllocationTracker::Get().StartRecording("allocations.trace");
+				}
+				else
+				{
+					AllocationTracker::Get().StopRecording();
+				}
+			}
+			ImGui::Text("Heap allocations = %llu (%llu bytes)", static_cast<unsigned long long>(_allocationReport.allocations),
+				static_cast<unsigned long long>(_allocationReport.bytes));
+			for (const auto& callsite : _allocationReport.callsites)
+			{
+				//the stack is only symbolized when the node is open
+				ImGui::PushID(static_cast<int>(callsite.hash));
+				if (ImGui::TreeNode("callsite", "%llu allocations, %llu bytes", static_cast<unsigned long long>(callsite.count),
+					static_cast<unsigned long long>(callsite.bytes)))
+				{
+					for (std::uint32_t i = 0; i < callsite.depth; i++)
+					{
+						ImGui::TextUnformatted(AllocationTracker::Symbolize(callsite.frames[i]).c_str());
+					}
+					ImGui::TreePop();
+				}
+				ImGui::PopID();
+			}
+#endif
+
+			ImGui::Text("Long jobs = %zu", _longJobs.GetPendingCount());
+			if (ImGui::Button("Forecast economy") && _longJobs.GetPendingCount() == 0)
+			{
+				_forecastDay = 0;
+				_longJobs.Add([&_forecastDay, &_forecastMoney](JobSystem::Coroutine::Yield yield)
+				{
+					//a year of hourly income and upkeep, one day per slice of frame time
+					float money = moneyGlob;
+					for (int day = 1; day <= 365; day++)
+					{
+						for (int hour = 0; hour < 24; hour++)
+						{
+							money += 10.0f + money * 0.00001f - std::sqrt(money) * 0.01f;
+						}
+						_forecastDay = day;
+						_forecastMoney = money;
+						yield();
+					}
+				}, "Economy forecast");
+			}
+			ImGui::Text("Forecast day %d : money = %f", _forecastDay, _forecastMoney);
+
 			ImGui::Text("House cost = 1000");
 			
 			if (ImGui::Button("House"))
@@ -125,9 +204,8 @@ namespace CityBuilderGame
 			if (!deletedSprite)
 			{
 				ZoneScopedN("testdrawfibercoroutine");
-				TRACY_FIBERS;
-				auto coroutine = std::make_shared<JobSystem::FiberCoroutine>();
-				TracyFiberEnter("coroutine");
+				auto coroutine = std::allocate_shared<JobSystem::FiberCoroutine>(
+					std::pmr::polymorphic_allocator<JobSystem::FiberCoroutine>(&_frameResource), "Draw coroutine");
 				coroutine->Setup([&](JobSystem::Coroutine::Yield yield)
 				{
 					_entity.MultipleDraw(_GameWindow);
@@ -138,12 +216,22 @@ namespace CityBuilderGame
 				{
 					_entity.MultipleDraw(_GameWindow);
 				}
-				TracyFiberLeave;
 			}
 			
+			//spend the rest of the frame budget on the long jobs
+			_longJobs.Update(std::chrono::microseconds(_frameClock.getElapsedTime().asMicroseconds()));
+
+			//the game loop runs inside one job, let the epoch advance once per frame
+			JobSystem::EpochManager::Get().Quiesce();
+
 			//display image
 			_GameWindow.display();
 
+			_frameAllocator.SwapFrames();
+#ifdef ALLOCATION_TRACKER
+			_allocationReport = AllocationTracker::Get().EndFrame(5);
+#endif
+
 		}
 		ImGui::SFML::Shutdown();
 		return EXIT_SUCCESS;
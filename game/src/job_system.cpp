@@ -4,21 +4,35 @@
 #include <atomic>
 #include <thread>
 #include <condition_variable>
+#include <cstring>
+#include <string>
+
+#include "epoch_reclamation.h"
+#include "sharded_counter.h"
 
 namespace JobSystem
 {
+	//a job with the name and color of its tracy zone
+	struct Job
+	{
+		std::function<void()> task;
+		const char* name = nullptr;
+		uint32_t color = 0;
+	};
+
 	uint32_t numThreads = 0;
-	ThreadSafeRingBuffer<std::function<void()>, 256> jobPool;
+	ThreadSafeRingBuffer<Job, 256> jobPool;
 	std::condition_variable wakeCondition;
 	std::mutex wakeMutex;
 	uint64_t currentLabel = 0;
-	std::atomic<uint64_t> finishedLabel;
+	// every worker counts its finished jobs on its own cache line
+	ShardedCounter<uint64_t> finishedLabel;
 	
 
 	void Initialize()
 	{
 		// Initialize the worker execution state to 0:
-		finishedLabel.store(0);
+		finishedLabel.Reset();
 
 		// Retrieve the number of hardware threads in this system:
 		auto numCores = std::thread::hardware_concurrency();
@@ -29,17 +43,37 @@ namespace JobSystem
 		// Create all our worker threads while immediately starting them:
 		for (uint32_t threadId = 0; threadId < numThreads; ++threadId)
 		{
-			std::thread worker ([]()
+			std::thread worker ([threadId]()
 			{
-				std::function<void()> job; // the current job for the thread, it's empty at start.
+#ifdef TRACY_ENABLE
+				const std::string threadName = "Job worker " + std::to_string(threadId);
+				tracy::SetThreadName(threadName.c_str());
+#endif
+				// workers can read lock free structures, their retired nodes wait for every worker
+				EpochManager::Get().RegisterThread();
+				Job job; // the current job for the thread, it's empty at start.
 				// This is the infinite loop that a worker thread will do
 				while (true)
 				{
 					if (jobPool.pop_front(job)) // try to grab a job from the jobPool queue
 					{
+						TracyPlot("Job queue depth", static_cast<int64_t>(jobPool.size()));
 						// It found a job, execute it:
-						job();
-						finishedLabel.fetch_add(1); // update worker label state
+						{
+							// pointers read from shared lock free structures stay valid for the whole job
+							EpochGuard epochGuard;
+							ZoneScopedN("Job");
+							if (job.name)
+							{
+								ZoneName(job.name, std::strlen(job.name));
+							}
+							if (job.color)
+							{
+								ZoneColor(job.color);
+							}
+							job.task();
+						}
+						finishedLabel.Increment(); // update worker label state
 					}
 					else
 					{
@@ -54,21 +88,23 @@ namespace JobSystem
 		}
 	}
 
-	void Execute(const std::function<void()>& job)
+	void Execute(const std::function<void()>& job, const char* name, uint32_t color)
 	{
 		// The main thread label state is updated:
 		currentLabel += 1;
 
 		// Try to push a new job until it is pushed successfully:
-		while (!jobPool.push_back(job))
+		while (!jobPool.push_back({ job, name, color }))
 		{
 			Pool();
 		}
+		TracyPlot("Job queue depth", static_cast<int64_t>(jobPool.size()));
 		// wake one thread
 		wakeCondition.notify_one();
 	}
 
-	void Dispatch(uint32_t jobCount, uint32_t groupSize, const std::function<void(JobDispatchArgs)>& job)
+	void Dispatch(uint32_t jobCount, uint32_t groupSize, const std::function<void(JobDispatchArgs)>& job,
+		const char* name, uint32_t color)
 	{
 		if (jobCount == 0 || groupSize == 0)
 		{
@@ -101,10 +137,11 @@ namespace JobSystem
 			};
 
 			// Try to push a new job until it is pushed successfully:
-			while (!jobPool.push_back(jobGroup)) 
+			while (!jobPool.push_back({ jobGroup, name, color }))
 			{
 				Pool();
 			}
+			TracyPlot("Job queue depth", static_cast<int64_t>(jobPool.size()));
 			wakeCondition.notify_one(); // wake one thread
 		}
 	}
@@ -112,7 +149,7 @@ namespace JobSystem
 	bool IsBusy()
 	{
 		// Whenever the main thread label is not reached by the workers, it indicates that some worker is still alive
-		return finishedLabel.load() < currentLabel;
+		return finishedLabel.Read() < currentLabel;
 	}
 
 	void Wait()
@@ -129,4 +166,107 @@ namespace JobSystem
 		std::this_thread::yield();	// allow this thread to be rescheduled
 	}
 
+
+	FiberPool& FiberPool::Get()
+	{
+		static FiberPool pool;
+		return pool;
+	}
+
+	void FiberPool::Configure(std::size_t stackSize, std::size_t capacity)
+	{
+		std::lock_guard<std::mutex> lock(lock_);
+		stackSize_ = stackSize;
+		capacity_ = capacity;
+		while (freeFibers_.size() < capacity_)
+		{
+			freeFibers_.push_back(Create(stackSize_));
+		}
+	}
+
+	PooledFiber* FiberPool::Acquire()
+	{
+		std::size_t stackSize;
+		{
+			std::lock_guard<std::mutex> lock(lock_);
+			if (!freeFibers_.empty())
+			{
+				PooledFiber* fiber = freeFibers_.back();
+				freeFibers_.pop_back();
+				return fiber;
+			}
+			// Configure can change it meanwhile, the fiber is created out of the lock
+			stackSize = stackSize_;
+		}
+		return Create(stackSize);
+	}
+
+	void FiberPool::Release(PooledFiber* fiber, bool finished)
+	{
+		fiber->owner = nullptr;
+		if (finished)
+		{
+			std::lock_guard<std::mutex> lock(lock_);
+			if (freeFibers_.size() < capacity_)
+			{
+				freeFibers_.push_back(fiber);
+				return;
+			}
+		}
+		DeleteFiber(fiber->handle);
+		delete fiber;
+	}
+
+	PooledFiber* FiberPool::Create(std::size_t stackSize)
+	{
+		auto* fiber = new PooledFiber();
+		fiber->handle = CreateFiberEx(0, stackSize, FIBER_FLAG_FLOAT_SWITCH, &FiberPool::Proc, fiber);
+		return fiber;
+	}
+
+	VOID WINAPI FiberPool::Proc(LPVOID data)
+	{
+		auto* fiber = reinterpret_cast<PooledFiber*>(data);
+		while (true)
+		{
+			// the owner changes each time the fiber is lent to a new coroutine
+			fiber->owner->run();
+		}
+	}
+
+	FrameScheduler::FrameScheduler(Clock::duration frameBudget, Clock::duration minRemaining) :
+		frameBudget_(frameBudget),
+		minRemaining_(minRemaining)
+	{
+	}
+
+	void FrameScheduler::Add(Coroutine::Run job, const char* name)
+	{
+		auto coroutine = std::make_unique<FiberCoroutine>(name);
+		coroutine->Setup(std::move(job));
+		jobs_.push_back(std::move(coroutine));
+	}
+
+	void FrameScheduler::Update(Clock::duration frameElapsed)
+	{
+		// the frame deadline, measured from the frame clock of the caller
+		const auto frameEnd = Clock::now() + (frameBudget_ - frameElapsed);
+
+		while (!jobs_.empty() && frameEnd - Clock::now() > minRemaining_)
+		{
+			if (nextJob_ >= jobs_.size())
+			{
+				nextJob_ = 0;
+			}
+			// run the job until its next checkpoint
+			if (jobs_[nextJob_]->Step())
+			{
+				++nextJob_;
+			}
+			else
+			{
+				jobs_.erase(jobs_.begin() + static_cast<std::ptrdiff_t>(nextJob_));
+			}
+		}
+	}
 }
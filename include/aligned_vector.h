@@ -0,0 +1,76 @@
+#pragma once
+
+#include <bit>
+#include <cstddef>
+#include <cstdlib>
+#include <limits>
+#include <new>
+#include <vector>
+
+//widest register the kernels are built for
+#if defined(__AVX__)
+constexpr std::size_t simdAlignment = 32;
+#else
+constexpr std::size_t simdAlignment = 16;
+#endif
+
+//elements of T in an Align bytes register
+template<typename T, std::size_t Align = simdAlignment>
+constexpr std::size_t LaneCount()
+{
+    return Align >= sizeof(T) ? Align / sizeof(T) : 1;
+}
+
+//count rounded up to whole registers
+template<typename T, std::size_t Align = simdAlignment>
+constexpr std::size_t PadToLanes(std::size_t count)
+{
+    constexpr std::size_t lanes = LaneCount<T, Align>();
+    return (count + lanes - 1) / lanes * lanes;
+}
+
+//Standard allocator returning Align aligned storage, padded to a whole number of Align bytes registers:
+//a kernel can load and store the last register whole, the lanes past the size are never read back.
+//The containers never check for nullptr: running out of memory aborts, exceptions are disabled.
+template<typename T, std::size_t Align = simdAlignment>
+class AlignedAllocator
+{
+public:
+    static_assert(std::has_single_bit(Align), "the alignment must be a power of two");
+    static_assert(Align >= alignof(T), "the alignment can't be lower than the one of the type");
+
+    using value_type = T;
+    template<typename U>
+    struct rebind
+    {
+        using other = AlignedAllocator<U, Align>;
+    };
+
+    AlignedAllocator() = default;
+    template<typename U>
+    AlignedAllocator(const AlignedAllocator<U, Align>&) noexcept {}
+
+    T* allocate(std::size_t n)
+    {
+        if (n > (std::numeric_limits<std::size_t>::max() - Align) / sizeof(T)) [[unlikely]]
+            std::abort();
+        return static_cast<T*>(::operator new(PaddedSize(n), std::align_val_t(Align)));
+    }
+
+    void deallocate(T* ptr, std::size_t) noexcept
+    {
+        ::operator delete(ptr, std::align_val_t(Align));
+    }
+
+    template<typename U>
+    bool operator==(const AlignedAllocator<U, Align>&) const noexcept { return true; }
+
+    static constexpr std::size_t PaddedSize(std::size_t n)
+    {
+        return (n * sizeof(T) + Align - 1) & ~(Align - 1);
+    }
+};
+
+//std::vector<float> whose data() can be used with _mm_load_ps/_mm256_load_ps, the tail included
+template<typename T, std::size_t Align = simdAlignment>
+using AlignedVector = std::vector<T, AlignedAllocator<T, Align>>;
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "custom_allocator.h"
+
+//Binary log of the heap allocations of a program, recorded by the AllocationTracker (StartRecording or the
+//ALLOCATION_TRACKER_TRACE environment variable) and replayed offline on any Allocator.
+//The file is an AllocationTraceHeader followed by records. Each thread writes its records in chunks, the
+//chunks of the threads are interleaved: the records are only ordered once sorted by timestamp.
+
+enum class AllocationEvent : std::uint8_t
+{
+    Allocate,
+    Deallocate
+};
+
+struct AllocationTraceRecord
+{
+    //nanoseconds since the start of the recording
+    std::uint64_t timestamp = 0;
+    std::uint64_t address = 0;
+    //0 for a Deallocate
+    std::uint32_t size = 0;
+    //slot of the thread in the tracker, the same for the whole life of a thread
+    std::uint16_t thread = 0;
+    std::uint8_t alignmentLog2 = 0;
+    AllocationEvent event = AllocationEvent::Allocate;
+};
+static_assert(sizeof(AllocationTraceRecord) == 24, "the records are written as is");
+
+struct AllocationTraceHeader
+{
+    static constexpr std::uint32_t traceMagic = 0x43525441; //ATRC
+    static constexpr std::uint32_t traceVersion = 1;
+
+    std::uint32_t magic = traceMagic;
+    std::uint32_t version = traceVersion;
+    std::uint32_t recordSize = sizeof(AllocationTraceRecord);
+    std::uint32_t reserved = 0;
+};
+
+//Returns false if the file can't be read or is not a trace
+//The records are sorted by timestamp, the records of one thread keep their order
+bool LoadAllocationTrace(const char* path, std::vector<AllocationTraceRecord>& records);
+
+struct ReplayResult
+{
+    double seconds = 0.0;
+    std::size_t allocations = 0;
+    std::size_t deallocations = 0;
+    std::size_t failedAllocations = 0;
+    //peak of the allocator used memory (headers, rounding and alignment included), 0 for malloc
+    std::size_t peakMemory = 0;
+};
+
+//The allocations and frees of a trace turned into a sequence of block ids, replayed the same way on every
+//allocator, in timestamp order on the calling thread
+class AllocationReplay
+{
+public:
+    explicit AllocationReplay(std::span<const AllocationTraceRecord> records);
+
+    //the blocks still alive at the end of the trace are freed after the timing
+    ReplayResult Run(Allocator& allocator) const;
+    ReplayResult RunMalloc() const;
+
+    [[nodiscard]] std::size_t GetOperationCount() const { return operations_.size(); }
+    //peak of the requested bytes alive at the same time, the lower bound of any allocator
+    [[nodiscard]] std::size_t GetPeakRequestedMemory() const { return peakRequestedMemory_; }
+    [[nodiscard]] std::size_t GetMaxAlignment() const { return maxAlignment_; }
+    //frees of blocks allocated before the recording started, they are not replayed
+    [[nodiscard]] std::size_t GetUnknownFreeCount() const { return unknownFrees_; }
+
+private:
+    struct Operation
+    {
+        std::uint32_t block = 0;
+        std::uint32_t size = 0;
+        std::uint32_t alignment = 0;
+        bool allocate = false;
+    };
+
+    template<typename Allocate, typename Deallocate>
+    ReplayResult Replay(Allocate allocate, Deallocate deallocate) const;
+
+    std::vector<Operation> operations_;
+    std::size_t blockCount_ = 0;
+    std::size_t peakRequestedMemory_ = 0;
+    std::size_t maxAlignment_ = 1;
+    std::size_t unknownFrees_ = 0;
+};
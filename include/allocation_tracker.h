@@ -0,0 +1,157 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "allocation_trace.h"
+#include "locks.h"
+
+//Heap allocation profiler. Linking the AllocationTracker target replaces the global operator new/delete
+//(and malloc/free with glibc) of the executable: every allocation is counted, one in sampleRate also records
+//the stack of its caller. The samples are aggregated per callsite in one table per thread, only written by
+//their thread, the reports read them without stopping the allocating threads.
+//Counts and bytes per callsite are estimates: each sample counts for sampleRate allocations.
+//
+//Setting the ALLOCATION_TRACKER_REPORT environment variable to a number prints that many top callsites at exit,
+//setting ALLOCATION_TRACKER_TRACE to a path records the whole run in that file.
+class AllocationTracker
+{
+public:
+    static constexpr std::size_t maxThreads = 64;
+    static constexpr std::size_t maxFrames = 12;
+    //distinct callsites per thread, the samples of new callsites are dropped once it is full
+    static constexpr std::size_t maxCallsites = 1024;
+
+    struct Callsite
+    {
+        std::uint64_t hash = 0;
+        std::uint32_t depth = 0;
+        //innermost caller first
+        std::array<void*, maxFrames> frames{};
+        std::uint64_t count = 0;
+        std::uint64_t bytes = 0;
+    };
+
+    struct Report
+    {
+        std::uint64_t allocations = 0;
+        std::uint64_t bytes = 0;
+        std::uint64_t deallocations = 0;
+        std::uint64_t droppedSamples = 0;
+        //allocations of the threads past maxThreads, counted nowhere else
+        std::uint64_t untrackedAllocations = 0;
+        //by decreasing bytes
+        std::vector<Callsite> callsites;
+    };
+
+    static AllocationTracker& Get();
+
+    //one allocation in rate records its stack, 1 records them all, 0 only counts
+    void SetSampleRate(std::uint32_t rate) { sampleRate_.store(rate, std::memory_order_relaxed); }
+    [[nodiscard]] std::uint32_t GetSampleRate() const { return sampleRate_.load(std::memory_order_relaxed); }
+    //stop counting and sampling, the hooks only forward to the system allocator
+    void SetEnabled(bool enabled) { enabled_.store(enabled, std::memory_order_relaxed); }
+
+    //allocations since the previous EndFrame, with its topCount callsites
+    //call it from one thread only, once per frame
+    Report EndFrame(std::size_t topCount);
+    //allocations since the start of the program
+    Report GetTotalReport(std::size_t topCount) const;
+
+    //function name of a frame, its address if it can't be resolved
+    static std::string Symbolize(void* address);
+    static void PrintReport(const Report& report, std::FILE* file = stdout);
+
+    //write every allocation and free of the tracked threads to path until StopRecording, see allocation_trace.h
+    //Returns false if the file can't be opened or a recording is already running
+    bool StartRecording(const char* path);
+    void StopRecording();
+    [[nodiscard]] bool IsRecording() const { return recording_.load(std::memory_order_relaxed); }
+
+    //called by the hooks
+    void OnAllocation(void* ptr, std::size_t size, std::size_t alignment);
+    //time : when the block was given back, the current time by default
+    void OnDeallocation(void* ptr, std::chrono::steady_clock::time_point time = {});
+
+private:
+    //records kept by a thread before it writes them to the trace
+    static constexpr std::size_t traceBufferSize = 1024;
+
+    struct Entry
+    {
+        //0 while the entry is free
+        std::uint64_t hash = 0;
+        std::uint32_t depth = 0;
+        std::array<void*, maxFrames> frames{};
+        //only the owner of the slot writes the counters
+        std::atomic<std::uint64_t> count{ 0 };
+        std::atomic<std::uint64_t> bytes{ 0 };
+    };
+
+    //per thread table, given back when its thread exits and reused with its content by the next thread
+    struct alignas(64) Slot
+    {
+        std::atomic<bool> inUse{ false };
+        std::atomic<std::uint64_t> allocations{ 0 };
+        std::atomic<std::uint64_t> bytes{ 0 };
+        std::atomic<std::uint64_t> deallocations{ 0 };
+        std::atomic<std::uint64_t> droppedSamples{ 0 };
+        //the reports only walk the used entries: usedEntries[0, entryCount) are published with entryCount
+        std::atomic<std::uint32_t> entryCount{ 0 };
+        std::array<std::uint16_t, maxCallsites> usedEntries{};
+        std::array<Entry, maxCallsites> entries;
+        //only contended when the recording stops and writes what is left
+        SpinLock traceLock;
+        std::uint32_t traceCount = 0;
+        std::array<AllocationTraceRecord, traceBufferSize> traceRecords;
+    };
+
+    //values read by the previous EndFrame, only touched by EndFrame
+    struct FrameState
+    {
+        std::uint64_t allocations = 0;
+        std::uint64_t bytes = 0;
+        std::uint64_t deallocations = 0;
+        std::uint64_t droppedSamples = 0;
+        std::array<std::uint64_t, maxCallsites> counts{};
+        std::array<std::uint64_t, maxCallsites> entryBytes{};
+    };
+
+    struct ThreadSlot
+    {
+        Slot* slot = nullptr;
+        ~ThreadSlot();
+    };
+
+    Slot* GetSlot();
+    void RecordSample(Slot& slot, std::size_t size, std::uint32_t rate);
+    void RecordEvent(Slot& slot, AllocationEvent event, void* ptr, std::size_t size, std::size_t alignment,
+        std::chrono::steady_clock::time_point time = {});
+    //called with the lock of the slot
+    void FlushTrace(Slot& slot);
+    //sum of the slots, subtracting the previous frame if previous is not null
+    Report Collect(std::size_t topCount, std::array<FrameState, maxThreads>* previous) const;
+
+    //static, the tables of the instance stay zero initialized (bss) and cost nothing until they are used
+    static inline std::atomic<std::uint32_t> sampleRate_{ 1 };
+    static inline std::atomic<bool> enabled_{ true };
+    std::atomic<std::uint64_t> untrackedAllocations_{ 0 };
+    std::array<Slot, maxThreads> slots_;
+    std::uint64_t previousUntrackedAllocations_ = 0;
+    std::array<FrameState, maxThreads> frameStates_;
+
+    std::atomic<bool> recording_{ false };
+    //written before recording_ is set
+    std::chrono::steady_clock::time_point traceStart_;
+    std::mutex traceFileLock_;
+    std::FILE* traceFile_ = nullptr;
+
+    static thread_local ThreadSlot threadSlot_;
+};
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <memory_resource>
+
+#include "custom_allocator.h"
+
+//std::pmr adapter over any Allocator, std::pmr::vector, std::pmr::string... can then live in our arenas.
+//When the allocator is full the request goes to upstream, deallocate sends the pointers it does not own back there.
+//A StackAllocator only frees in LIFO order: containers on it must not grow once something was allocated after them.
+class AllocatorResource final : public std::pmr::memory_resource
+{
+public:
+    explicit AllocatorResource(Allocator& allocator,
+                               std::pmr::memory_resource* upstream = std::pmr::get_default_resource());
+
+    [[nodiscard]] Allocator& GetAllocator() const { return allocator_; }
+    [[nodiscard]] std::pmr::memory_resource* GetUpstream() const { return upstream_; }
+    //allocations that did not fit in the allocator
+    [[nodiscard]] std::size_t GetUpstreamAllocationCount() const { return upstreamAllocations_; }
+private:
+    void* do_allocate(std::size_t bytes, std::size_t alignment) override;
+    void do_deallocate(void* ptr, std::size_t bytes, std::size_t alignment) override;
+    [[nodiscard]] bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+
+    Allocator& allocator_;
+    std::pmr::memory_resource* upstream_;
+    std::size_t upstreamAllocations_ = 0;
+};
+
+//Monotonic resource for the data of one frame: a LinearAllocator over a buffer taken once from upstream.
+//deallocate is free, everything is released at once by Reset at the end of the frame.
+//Containers using it must be gone before Reset.
+class FrameResource final : public std::pmr::memory_resource
+{
+public:
+    explicit FrameResource(std::size_t size, std::pmr::memory_resource* upstream = std::pmr::get_default_resource());
+    ~FrameResource() override;
+    FrameResource(const FrameResource&) = delete;
+    FrameResource& operator=(const FrameResource&) = delete;
+
+    void Reset();
+    [[nodiscard]] const LinearAllocator& GetAllocator() const { return allocator_; }
+private:
+    void* do_allocate(std::size_t bytes, std::size_t alignment) override;
+    void do_deallocate(void* ptr, std::size_t bytes, std::size_t alignment) override;
+    [[nodiscard]] bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+
+    static constexpr std::size_t bufferAlignment = 64;
+    std::pmr::memory_resource* upstream_;
+    void* buffer_;
+    std::size_t size_;
+    LinearAllocator allocator_;
+};
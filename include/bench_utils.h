@@ -1,5 +1,7 @@
 #pragma once
 
+#include <cstddef>
+#include <span>
 #include <vector>
 
 #include "vector3.h"
@@ -29,4 +31,7 @@ void FillRandom(maths::NVec3f<N>& v)
     }
 }
 void FillRandom(maths::Mat4f& m);
-void FillRandom(std::vector<int>& v, int low, int high);
\ No newline at end of file
+void FillRandom(std::span<int> v, int low, int high);
+
+//bytes of the process currently in physical memory
+std::size_t GetResidentMemory();
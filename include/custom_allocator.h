@@ -1,7 +1,13 @@
 #pragma once
 
+#include <algorithm>
+#include <array>
+#include <atomic>
 #include <cstdint>
 #include <cstdlib>
+#include <memory>
+
+#include "locks.h"
 
 inline void* alignForward(const void* address, std::uintptr_t alignment)
 {
@@ -21,6 +27,10 @@ inline std::uintptr_t alignForwardAdjustment(const void* address, std::uintptr_t
 class Allocator
 {
 public:
+    //allocation sizes are counted in power of two buckets, the last one holds everything bigger
+    static constexpr std::size_t sizeHistogramBucketCount = 24;
+    using SizeHistogram = std::array<std::size_t, sizeHistogramBucketCount>;
+
     Allocator(void* rootPtr, std::size_t totalSize) : rootPtr_(rootPtr), totalSize_(totalSize){}
     virtual ~Allocator() = default;
     virtual void* Allocate(std::size_t allocationSize, std::size_t alignment) = 0;
@@ -28,11 +38,43 @@ public:
     [[nodiscard]] std::size_t GetTotalSize() const { return totalSize_; }
     [[nodiscard]] std::size_t GetUsedMemory() const { return usedMemory_; }
     [[nodiscard]] std::size_t GetNumAllocations() const { return numAllocations_; }
+    //high water mark of GetUsedMemory, what the arena must hold
+    [[nodiscard]] std::size_t GetPeakMemory() const { return peakMemory_; }
+    //Allocate calls that returned nullptr
+    [[nodiscard]] std::size_t GetFailedAllocationCount() const { return failedAllocations_; }
+    //bucket i counts the allocations of at most 2^i bytes that did not fit in bucket i - 1
+    [[nodiscard]] const SizeHistogram& GetSizeHistogram() const { return sizeHistogram_; }
+    static std::size_t GetSizeHistogramBucket(std::size_t allocationSize);
+
+    //name of the memory pool in tracy, must outlive the allocator
+    void SetName(const char* name) { name_ = name; }
+    [[nodiscard]] const char* GetName() const { return name_; }
+    //true if ptr points in the memory managed by this allocator
+    [[nodiscard]] virtual bool Owns(const void* ptr) const
+    {
+        const auto address = reinterpret_cast<std::uintptr_t>(ptr);
+        const auto root = reinterpret_cast<std::uintptr_t>(rootPtr_);
+        return address >= root && address < root + totalSize_;
+    }
 protected:
+    //bookkeeping of the allocators, called once usedMemory_ and numAllocations_ are updated
+    //Allocations freed one by one are reported to tracy as memory events
+    void RecordAllocation(void* ptr, std::size_t allocationSize);
+    void RecordDeallocation(void* ptr);
+    //arenas released at once (LinearAllocator, stacks released to a marker) are reported as a plot of their
+    //used memory instead, tracy can't free all their allocations in one event
+    void RecordArenaAllocation(std::size_t allocationSize);
+    void RecordArenaReset();
+    void RecordFailure() { failedAllocations_++; }
+
     void* rootPtr_ = nullptr;
     std::size_t totalSize_ = 0;
     std::size_t usedMemory_ = 0;
     std::size_t numAllocations_ = 0;
+    std::size_t peakMemory_ = 0;
+    std::size_t failedAllocations_ = 0;
+    SizeHistogram sizeHistogram_{};
+    const char* name_ = "Allocator";
 };
 
 class LinearAllocator final : public Allocator
@@ -46,12 +88,47 @@ private:
     void* currentPtr_ = nullptr;
 };
 
+//Two LinearAllocator regions swapped every frame: memory allocated during frame N stays valid until the end
+//of frame N+1, long enough to hand it to the render or to jobs finishing during the next frame.
+//Swapping clears the older region in O(1), Deallocate does nothing.
+class DoubleFrameAllocator final : public Allocator
+{
+public:
+    //each frame gets half of totalSize
+    DoubleFrameAllocator(void* rootPtr, std::size_t totalSize);
+    void* Allocate(std::size_t allocationSize, std::size_t alignment) override;
+    void Deallocate(void* ptr) override;
+    //end of frame: the current region becomes the previous one, the older one is cleared for the next frame
+    void SwapFrames();
+
+    [[nodiscard]] std::size_t GetFrameCapacity() const { return frames_[0].GetTotalSize(); }
+    [[nodiscard]] std::size_t GetFrameUsedMemory() const { return frames_[current_].GetUsedMemory(); }
+    [[nodiscard]] std::size_t GetFrameNumAllocations() const { return frames_[current_].GetNumAllocations(); }
+    [[nodiscard]] std::size_t GetLastFrameUsedMemory() const { return frames_[current_ ^ 1].GetUsedMemory(); }
+    //highest usage of a single frame since the creation, what the frame capacity must hold
+    [[nodiscard]] std::size_t GetPeakFrameUsedMemory() const { return std::max(peakFrameUsedMemory_, GetFrameUsedMemory()); }
+private:
+    std::array<LinearAllocator, 2> frames_;
+    std::size_t current_ = 0;
+    std::size_t peakFrameUsedMemory_ = 0;
+};
+
+//Position in a stack allocator, everything allocated after it is released at once by FreeToMarker
+struct StackMarker
+{
+    std::size_t offset = 0;
+    std::size_t numAllocations = 0;
+};
+
 class StackAllocator final : public Allocator
 {
 public:
     StackAllocator(void* rootPtr, std::size_t totalSize);
     void* Allocate(std::size_t allocationSize, std::size_t alignment) override;
     void Deallocate(void* ptr) override;
+    //release a whole scope in O(1): every allocation made since GetMarker
+    [[nodiscard]] StackMarker GetMarker() const { return { usedMemory_, numAllocations_ }; }
+    void FreeToMarker(StackMarker marker);
 
 private:
     struct AllocationHeader
@@ -62,6 +139,46 @@ private:
     void* currentPos_ = nullptr;
 };
 
+//Stack growing from both ends of one buffer, the free memory is between them. Typically long lived data
+//(level, assets) at the bottom and per frame data at the top, the level block needs no other allocator.
+//Each end is released LIFO with Deallocate or with its markers.
+class DoubleEndedStackAllocator final : public Allocator
+{
+public:
+    DoubleEndedStackAllocator(void* rootPtr, std::size_t totalSize);
+    //same as AllocateBottom
+    void* Allocate(std::size_t allocationSize, std::size_t alignment) override;
+    //last allocation of the end ptr comes from
+    void Deallocate(void* ptr) override;
+
+    void* AllocateBottom(std::size_t allocationSize, std::size_t alignment);
+    void* AllocateTop(std::size_t allocationSize, std::size_t alignment);
+
+    //offsets count from the start of the buffer for the bottom and from its end for the top
+    [[nodiscard]] StackMarker GetBottomMarker() const { return { bottom_, bottomAllocations_ }; }
+    [[nodiscard]] StackMarker GetTopMarker() const { return { top_, topAllocations_ }; }
+    void FreeToBottomMarker(StackMarker marker);
+    void FreeToTopMarker(StackMarker marker);
+
+    [[nodiscard]] std::size_t GetBottomUsedMemory() const { return bottom_; }
+    [[nodiscard]] std::size_t GetTopUsedMemory() const { return top_; }
+private:
+    //before every allocation: the offset of its end before the allocation
+    struct AllocationHeader
+    {
+        std::size_t previousOffset = 0;
+    };
+    void Update();
+
+    std::size_t bottom_ = 0;
+    std::size_t top_ = 0;
+    std::size_t bottomAllocations_ = 0;
+    std::size_t topAllocations_ = 0;
+};
+
+//General purpose allocator, first fit over a doubly linked list of free blocks.
+//Every block carries a boundary tag (its size and an allocated flag) at both ends, so a freed block finds
+//its physical neighbours in O(1) and merges with the free ones without walking the free list.
 class FreeListAllocator final : public Allocator
 {
 public:
@@ -69,18 +186,251 @@ public:
 
     void* Allocate(std::size_t allocationSize, std::size_t alignment) override;
     void Deallocate(void* ptr) override;
+    [[nodiscard]] std::size_t GetFreeBlockCount() const;
+    //walk the free list
+    [[nodiscard]] std::size_t GetLargestFreeBlock() const;
+    //1 - largest free block / free memory: 0 when the free memory is in one block, close to 1 when it is
+    //scattered in blocks too small for a big allocation
+    [[nodiscard]] float GetFragmentation() const;
 private:
+    //block size, the lowest bit is set when the block is allocated
+    struct BoundaryTag
+    {
+        std::size_t sizeAndFlag = 0;
+    };
+    //start of a free block, the links live in the free memory itself
+    struct FreeBlock
+    {
+        BoundaryTag header;
+        FreeBlock* prev = nullptr;
+        FreeBlock* next = nullptr;
+    };
+    //just before the returned pointer, distance to the start of the block
     struct AllocationHeader
     {
-        std::size_t allocationSize = 0;
-        std::uint8_t adjustment = 0;
+        std::size_t blockOffset = 0;
+    };
+    static constexpr std::size_t blockAlignment = 16;
+    static constexpr std::size_t allocatedFlag = 1;
+    static constexpr std::size_t minBlockSize = (sizeof(FreeBlock) + sizeof(BoundaryTag) + blockAlignment - 1) & ~(blockAlignment - 1);
+
+    static std::size_t GetSize(std::uintptr_t block) { return reinterpret_cast<const BoundaryTag*>(block)->sizeAndFlag & ~allocatedFlag; }
+    static bool IsAllocated(std::uintptr_t block) { return reinterpret_cast<const BoundaryTag*>(block)->sizeAndFlag & allocatedFlag; }
+    static void SetTags(std::uintptr_t block, std::size_t size, bool allocated);
+    void InsertFreeBlock(std::uintptr_t block, std::size_t size);
+    void RemoveFreeBlock(FreeBlock* block);
+
+    std::uintptr_t heapStart_ = 0;
+    std::uintptr_t heapEnd_ = 0;
+    FreeBlock* freeBlocks_ = nullptr;
+};
+
+//Two Level Segregated Fit: general purpose allocator with O(1) Allocate and Deallocate in the worst case.
+//Free blocks are sorted in size classes: a first level per power of two, split linearly in secondLevelCount
+//second level classes. A bitmap per level tells which classes have blocks, find first set gives the first
+//class big enough without any search. The request is rounded up to the next class so any block of that
+//class fits (good fit, not best fit). Neighbours merge in O(1) through boundary tags like FreeListAllocator.
+class TlsfAllocator final : public Allocator
+{
+public:
+    TlsfAllocator(void* rootPtr, std::size_t totalSize);
+    void* Allocate(std::size_t allocationSize, std::size_t alignment) override;
+    void Deallocate(void* ptr) override;
+    [[nodiscard]] std::size_t GetFreeBlockCount() const;
+private:
+    //the header sits right before the payload, the size of a free block is repeated in its last word
+    struct BlockHeader
+    {
+        //block size with the flags in the low bits
+        std::size_t sizeAndFlags = 0;
+        //only in free blocks
+        BlockHeader* nextFree = nullptr;
+        BlockHeader* prevFree = nullptr;
+    };
+    static constexpr std::size_t blockAlignment = 16;
+    static constexpr std::size_t freeFlag = 1;
+    static constexpr std::size_t prevFreeFlag = 2;
+    static constexpr std::size_t flagMask = freeFlag | prevFreeFlag;
+    static constexpr std::size_t minBlockSize = 32;
+    static constexpr std::size_t secondLevelLog2 = 5;
+    static constexpr std::size_t secondLevelCount = std::size_t(1) << secondLevelLog2;
+    //blocks under smallBlockSize are all in the first level 0, in classes of blockAlignment bytes
+    static constexpr std::size_t firstLevelShift = secondLevelLog2 + 4;
+    static constexpr std::size_t smallBlockSize = std::size_t(1) << firstLevelShift;
+    static constexpr std::size_t firstLevelCount = 40;
+
+    static std::size_t GetSize(const BlockHeader* block) { return block->sizeAndFlags & ~flagMask; }
+    static BlockHeader* GetNext(BlockHeader* block) { return reinterpret_cast<BlockHeader*>(reinterpret_cast<char*>(block) + GetSize(block)); }
+    static void MapInsert(std::size_t size, std::size_t& firstLevel, std::size_t& secondLevel);
+    void InsertFreeBlock(BlockHeader* block, std::size_t size);
+    void RemoveFreeBlock(BlockHeader* block);
+    //first free block of at least size bytes, removed from its list
+    BlockHeader* TakeFreeBlock(std::size_t size);
+    //give the end of the block back as a free block if it can hold one
+    void TrimBlock(BlockHeader* block, std::size_t size);
+
+    std::uint64_t firstLevelBitmap_ = 0;
+    std::array<std::uint32_t, firstLevelCount> secondLevelBitmaps_{};
+    std::array<std::array<BlockHeader*, secondLevelCount>, firstLevelCount> freeBlocks_{};
+};
+
+//Power of two blocks split in halves (buddies) on demand and merged back when both halves are free.
+//Allocations are rounded up to a power of two times minBlockSize, the waste stays under half of the block
+//and a free block always merges with its buddy, the free memory can't be scattered in tiny pieces.
+//Allocate and Deallocate are O(log n): per order doubly linked free lists, and two bitmaps over the
+//implicit tree of blocks (free, split) stored at the end of the buffer.
+class BuddyAllocator final : public Allocator
+{
+public:
+    //minBlockSize : smallest block, a power of two holding at least two pointers
+    BuddyAllocator(void* rootPtr, std::size_t totalSize, std::size_t minBlockSize = 64);
+    //Returns nullptr when no block of the needed order is free, or the alignment is bigger than the block
+    //alignment given by the buffer
+    void* Allocate(std::size_t allocationSize, std::size_t alignment) override;
+    void Deallocate(void* ptr) override;
+
+    [[nodiscard]] std::size_t GetMinBlockSize() const { return minBlockSize_; }
+    [[nodiscard]] std::size_t GetMaxOrder() const { return maxOrder_; }
+    //memory given to blocks, what is left of the buffer after the bitmaps
+    [[nodiscard]] std::size_t GetHeapSize() const { return heapBlocks_ * minBlockSize_; }
+    //order of the smallest block holding allocationSize bytes with alignment
+    [[nodiscard]] std::size_t GetOrder(std::size_t allocationSize, std::size_t alignment) const;
+    [[nodiscard]] std::size_t GetFreeBlockCount(std::size_t order) const;
+private:
+    struct FreeBlock
+    {
+        FreeBlock* prev = nullptr;
+        FreeBlock* next = nullptr;
     };
+    static constexpr std::size_t maxOrders = 48;
+
+    //index in the bitmaps, the root is 0 and the children of node n are 2n+1 and 2n+2
+    [[nodiscard]] std::size_t NodeIndex(std::size_t order, std::size_t index) const
+    {
+        return (std::size_t(1) << (maxOrder_ - order)) - 1 + index;
+    }
+    [[nodiscard]] static bool GetBit(const std::uint64_t* bits, std::size_t node) { return (bits[node / 64] >> (node % 64)) & 1; }
+    static void SetBit(std::uint64_t* bits, std::size_t node, bool value);
+    [[nodiscard]] std::uintptr_t BlockAddress(std::size_t order, std::size_t index) const
+    {
+        return heapStart_ + (index << order) * minBlockSize_;
+    }
+    void PushFreeBlock(std::size_t order, std::size_t index);
+    void RemoveFreeBlock(std::size_t order, std::size_t index);
+    void BuildTree(std::size_t order, std::size_t index);
+
+    std::size_t minBlockSize_ = 0;
+    std::size_t maxOrder_ = 0;
+    std::size_t heapBlocks_ = 0;
+    std::uintptr_t heapStart_ = 0;
+    std::size_t heapAlignment_ = 0;
+    std::uint64_t* freeBits_ = nullptr;
+    std::uint64_t* splitBits_ = nullptr;
+    std::array<FreeBlock*, maxOrders> freeLists_{};
+};
+
+//Fixed size blocks, O(1) allocate and deallocate through an intrusive free list stored in the free blocks
+class PoolAllocator final : public Allocator
+{
+public:
+    //objectSize, objectAlignment : every block holds one object of this size and alignment
+    PoolAllocator(void* rootPtr, std::size_t totalSize, std::size_t objectSize, std::size_t objectAlignment);
+    //Returns nullptr if the allocation is bigger or more aligned than a block
+    void* Allocate(std::size_t allocationSize, std::size_t alignment) override;
+    void Deallocate(void* ptr) override;
+    [[nodiscard]] std::size_t GetBlockSize() const { return blockSize_; }
+private:
     struct FreeBlock
     {
-        std::size_t freeSize = 0;
         FreeBlock* next = nullptr;
     };
+    std::size_t blockSize_ = 0;
+    std::size_t blockAlignment_ = 0;
     FreeBlock* freeBlocks_ = nullptr;
-    static std::uintptr_t AlignForwardAdjustmentWithHeader(const void* address, std::uintptr_t alignment);
-        
-};
\ No newline at end of file
+};
+
+//Thread safe PoolAllocator, the free list is a lock free stack.
+//The head packs the index of the first free block with a tag incremented on every change, a thread that
+//read a stale head fails its compare exchange instead of corrupting the list (ABA).
+//The statistics (usedMemory, numAllocations, peak...) are not tracked, they would be shared counters on the fast path.
+class ConcurrentPoolAllocator final : public Allocator
+{
+public:
+    ConcurrentPoolAllocator(void* rootPtr, std::size_t totalSize, std::size_t objectSize, std::size_t objectAlignment);
+    void* Allocate(std::size_t allocationSize, std::size_t alignment) override;
+    void Deallocate(void* ptr) override;
+    [[nodiscard]] std::size_t GetBlockSize() const { return blockSize_; }
+    [[nodiscard]] std::size_t GetBlockCount() const { return blockCount_; }
+private:
+    static constexpr std::uint32_t invalidIndex = 0xFFFFFFFFu;
+    static std::uint64_t MakeHead(std::uint64_t tag, std::uint32_t index) { return (tag << 32) | index; }
+    std::uint32_t& NextIndex(std::uint32_t index) const;
+
+    std::uintptr_t firstBlock_ = 0;
+    std::size_t blockSize_ = 0;
+    std::size_t blockAlignment_ = 0;
+    std::size_t blockCount_ = 0;
+    alignas(64) std::atomic<std::uint64_t> head_{0};
+};
+
+//Thread safe front end over a single threaded allocator, in the style of tcmalloc.
+//Small allocations are rounded to a size class and served from magazines of the calling thread, a magazine
+//refills from the backing allocator and flushes back to it in batches, so the shared lock is taken once per
+//batch instead of once per call. Blocks freed by another thread go to the magazines of that thread.
+//Bigger or over aligned allocations go straight to the backing allocator under its lock.
+//The statistics are not tracked, the backing allocator sees the batches.
+class ThreadCachingAllocator final : public Allocator
+{
+public:
+    static constexpr std::size_t sizeClassCount = 8;
+    static constexpr std::size_t minClassSize = 16;
+    static constexpr std::size_t maxClassSize = minClassSize << (sizeClassCount - 1);
+    //blocks moved between a magazine and the backing allocator at once
+    static constexpr std::size_t batchSize = 16;
+    static constexpr std::size_t magazineCapacity = 2 * batchSize;
+    //threads past maxCaches share a cache, still correct but they contend on its lock
+    static constexpr std::size_t maxCaches = 64;
+
+    //backing must outlive this allocator
+    explicit ThreadCachingAllocator(Allocator& backing);
+    ~ThreadCachingAllocator() override;
+    void* Allocate(std::size_t allocationSize, std::size_t alignment) override;
+    void Deallocate(void* ptr) override;
+    //give the blocks cached by the calling thread back to the backing allocator
+    void FlushThreadCache();
+    [[nodiscard]] bool Owns(const void* ptr) const override { return backing_.Owns(ptr); }
+
+    static std::size_t GetSizeClass(std::size_t allocationSize);
+    static std::size_t GetClassSize(std::size_t sizeClass) { return minClassSize << sizeClass; }
+private:
+    //just before the returned pointer
+    struct AllocationHeader
+    {
+        std::uint32_t sizeClass = 0;
+        std::uint32_t offset = 0;
+    };
+    static constexpr std::size_t headerSize = 16;
+    static constexpr std::uint32_t largeClass = sizeClassCount;
+
+    struct Magazine
+    {
+        std::array<void*, magazineCapacity> blocks{};
+        std::size_t count = 0;
+    };
+    struct alignas(64) ThreadCache
+    {
+        //only contended when several threads share the cache
+        SpinLock lock;
+        std::array<Magazine, sizeClassCount> magazines;
+    };
+
+    ThreadCache& GetThreadCache() const;
+    bool Refill(Magazine& magazine, std::size_t sizeClass);
+    void Flush(Magazine& magazine, std::size_t count);
+    void FlushCache(ThreadCache& cache);
+    static AllocationHeader& GetHeader(void* ptr) { return *(static_cast<AllocationHeader*>(ptr) - 1); }
+
+    Allocator& backing_;
+    SpinLock backingLock_;
+    std::unique_ptr<ThreadCache[]> caches_;
+};
@@ -0,0 +1,110 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+namespace JobSystem
+{
+	//Epoch based reclamation: deferred freeing of nodes unlinked from lock free containers.
+	//Readers only publish the global epoch when they enter a critical region, no per access cost like
+	//hazard pointers. A retired object is freed once the global epoch moved twice after its retirement,
+	//which can only happen when every thread in a critical region has seen the new epochs.
+	class EpochManager
+	{
+	public:
+		static constexpr std::size_t maxThreads = 64;
+		//retired objects waiting in a thread before it tries to advance the epoch
+		static constexpr std::size_t retireBatch = 64;
+
+		using Deleter = void (*)(void*);
+
+		static EpochManager& Get();
+
+		//give a slot to the calling thread, done automatically by the first Enter
+		//Returns false if all the slots are taken
+		bool RegisterThread();
+		//release the slot of the calling thread, its retired objects are freed later by the other threads
+		void UnregisterThread();
+
+		//begin a critical region, pointers read from shared structures stay valid until Exit
+		//nested regions are allowed
+		void Enter();
+		void Exit();
+
+		//quiescent point inside a long critical region: the caller holds no shared pointer anymore,
+		//equivalent to Exit then Enter
+		void Quiesce();
+
+		//free ptr with deleter when no thread can hold it anymore, ptr must already be unreachable
+		void Retire(void* ptr, Deleter deleter);
+		template<typename T>
+		void Retire(T* ptr)
+		{
+			Retire(ptr, [](void* p) { delete static_cast<T*>(p); });
+		}
+
+		//advance the global epoch if every thread in a critical region reached it
+		bool TryAdvance();
+		//free the retired objects of the calling thread that are two epochs old
+		void Collect();
+
+		[[nodiscard]] std::uint64_t GetEpoch() const { return globalEpoch_.load(std::memory_order_acquire); }
+
+	private:
+		struct Retired
+		{
+			void* ptr = nullptr;
+			Deleter deleter = nullptr;
+		};
+		//objects retired during one epoch
+		struct Limbo
+		{
+			std::uint64_t epoch = 0;
+			std::vector<Retired> objects;
+		};
+
+		struct alignas(64) Slot
+		{
+			//(epoch << 1) | 1 while in a critical region, 0 outside
+			std::atomic<std::uint64_t> state{ 0 };
+			std::atomic<bool> inUse{ false };
+			//only touched by the owner thread
+			std::array<Limbo, 3> limbo;
+			std::size_t retiredCount = 0;
+			std::size_t depth = 0;
+		};
+
+		//releases the slot when its thread exits
+		struct ThreadSlot
+		{
+			Slot* slot = nullptr;
+			~ThreadSlot();
+		};
+
+		Slot* GetSlot();
+		static void Free(Limbo& limbo);
+		void CollectOrphans();
+
+		std::atomic<std::uint64_t> globalEpoch_{ 0 };
+		std::array<Slot, maxThreads> slots_;
+
+		std::mutex orphanLock_;
+		std::vector<Limbo> orphans_;
+		std::atomic<bool> hasOrphans_{ false };
+
+		static thread_local ThreadSlot threadSlot_;
+	};
+
+	//RAII critical region on the global EpochManager
+	class EpochGuard
+	{
+	public:
+		EpochGuard() { EpochManager::Get().Enter(); }
+		~EpochGuard() { EpochManager::Get().Exit(); }
+		EpochGuard(const EpochGuard&) = delete;
+		EpochGuard& operator=(const EpochGuard&) = delete;
+	};
+}
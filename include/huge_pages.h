@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdlib>
+#include <limits>
+
+//Memory backed by 2MB pages: one TLB entry covers 512 times more memory than with 4KB pages,
+//random accesses over a large working set stop missing the TLB at every access.
+constexpr std::size_t hugePageSize = 2 * 1024 * 1024;
+
+enum class HugePageMode
+{
+    //regular pages, the system refused the huge pages
+    None,
+    //reserved huge pages (MAP_HUGETLB, MEM_LARGE_PAGES), needs a pool configured by the system
+    Explicit,
+    //transparent huge pages (madvise MADV_HUGEPAGE), the kernel promotes the region when it can
+    Transparent
+};
+
+[[nodiscard]] constexpr std::size_t RoundToHugePages(std::size_t size)
+{
+    return (size + hugePageSize - 1) / hugePageSize * hugePageSize;
+}
+
+//map size bytes (rounded to whole huge pages) with explicit huge pages, or with transparent huge pages
+//when there are none available. mode receives what backs the region. Returns nullptr on failure
+void* AllocateHugePages(std::size_t size, HugePageMode* mode = nullptr);
+void FreeHugePages(void* ptr, std::size_t size);
+
+#ifndef _WIN32
+//map size bytes aligned on a huge page (the kernel can only back aligned 2MB ranges with one) and ask for
+//transparent huge pages. reserveOnly maps the range PROT_NONE without reserving swap, to commit it later.
+//transparent receives whether the kernel accepted the advice. Returns nullptr on failure, free with munmap
+void* MapHugePageAligned(std::size_t size, bool reserveOnly, bool* transparent);
+#endif
+
+//std allocator over AllocateHugePages, for the containers of large working sets:
+//std::vector<int, HugePageAllocator<int>>. Every allocation takes at least one 2MB page.
+//AllocateHugePages already falls back to regular pages, when even those can't be mapped the program aborts:
+//the containers never check for nullptr and exceptions are disabled.
+template<typename T>
+class HugePageAllocator
+{
+public:
+    using value_type = T;
+
+    HugePageAllocator() = default;
+    template<typename U>
+    HugePageAllocator(const HugePageAllocator<U>&) noexcept {}
+
+    T* allocate(std::size_t n)
+    {
+        if (n > (std::numeric_limits<std::size_t>::max() - hugePageSize) / sizeof(T)) [[unlikely]]
+            std::abort();
+        void* ptr = AllocateHugePages(n * sizeof(T));
+        if (ptr == nullptr) [[unlikely]]
+            std::abort();
+        return static_cast<T*>(ptr);
+    }
+
+    void deallocate(T* ptr, std::size_t n) noexcept
+    {
+        FreeHugePages(ptr, n * sizeof(T));
+    }
+
+    template<typename U>
+    bool operator==(const HugePageAllocator<U>&) const noexcept { return true; }
+};
@@ -0,0 +1,226 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <thread>
+
+#include "instrinsics.h"
+
+//Locks with the std::mutex interface (lock, try_lock, unlock), usable with std::lock_guard and as the
+//Lock parameter of ThreadSafeRingBuffer. Meant for short critical sections: waiters spin instead of sleeping.
+
+//tell the cpu we are spinning, frees the pipeline for the other hyperthread
+inline void CpuRelax()
+{
+#if defined(__x86_64__) || defined(_M_X64)
+    _mm_pause();
+#elif defined(__aarch64__)
+    asm volatile("yield");
+#endif
+}
+
+//exponential backoff between two reads of a contended lock, gives the core away once it waited too long
+class Backoff
+{
+public:
+    void Pause()
+    {
+        if (count_ >= maxSpins)
+        {
+            std::this_thread::yield();
+            return;
+        }
+        for (std::uint32_t i = 0; i < count_; i++)
+        {
+            CpuRelax();
+        }
+        count_ *= 2;
+    }
+private:
+    static constexpr std::uint32_t maxSpins = 1024;
+    std::uint32_t count_ = 1;
+};
+
+//test and test and set: waiters only read the flag until it looks free, then try to take it
+class SpinLock
+{
+public:
+    void lock()
+    {
+        Backoff backoff;
+        while (locked_.exchange(true, std::memory_order_acquire))
+        {
+            while (locked_.load(std::memory_order_relaxed))
+            {
+                backoff.Pause();
+            }
+        }
+    }
+
+    bool try_lock()
+    {
+        return !locked_.load(std::memory_order_relaxed) && !locked_.exchange(true, std::memory_order_acquire);
+    }
+
+    void unlock()
+    {
+        locked_.store(false, std::memory_order_release);
+    }
+private:
+    alignas(64) std::atomic<bool> locked_{false};
+};
+
+//fair lock: threads take a ticket and are served in order
+class TicketLock
+{
+public:
+    void lock()
+    {
+        const std::uint32_t ticket = nextTicket_.fetch_add(1, std::memory_order_relaxed);
+        Backoff backoff;
+        while (nowServing_.load(std::memory_order_acquire) != ticket)
+        {
+            backoff.Pause();
+        }
+    }
+
+    bool try_lock()
+    {
+        std::uint32_t serving = nowServing_.load(std::memory_order_relaxed);
+        return nextTicket_.compare_exchange_strong(serving, serving + 1, std::memory_order_acquire);
+    }
+
+    void unlock()
+    {
+        //only the owner writes nowServing_
+        nowServing_.store(nowServing_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+private:
+    alignas(64) std::atomic<std::uint32_t> nextTicket_{0};
+    alignas(64) std::atomic<std::uint32_t> nowServing_{0};
+};
+
+//MCS queue lock: fair, and each waiter spins on its own node instead of the shared lock word,
+//the release only touches the cache line of the next waiter.
+//Nodes come from a small per thread pool of maxHeldLocks nodes, a thread holding more McsLock at the same time
+//takes the extra nodes from the heap.
+class McsLock
+{
+public:
+    struct alignas(64) Node
+    {
+        std::atomic<Node*> next{nullptr};
+        std::atomic<bool> locked{false};
+    };
+
+    void lock()
+    {
+        Node* node = AcquireNode();
+        lock(*node);
+        //only the owner reads or writes owner_
+        owner_ = node;
+    }
+
+    bool try_lock()
+    {
+        Node* node = AcquireNode();
+        node->next.store(nullptr, std::memory_order_relaxed);
+        Node* expected = nullptr;
+        if (!tail_.compare_exchange_strong(expected, node, std::memory_order_acquire))
+        {
+            ReleaseNode(node);
+            return false;
+        }
+        owner_ = node;
+        return true;
+    }
+
+    void unlock()
+    {
+        Node* node = owner_;
+        unlock(*node);
+        ReleaseNode(node);
+    }
+
+    //explicit node version, the node must stay alive until unlock
+    void lock(Node& node)
+    {
+        node.next.store(nullptr, std::memory_order_relaxed);
+        node.locked.store(true, std::memory_order_relaxed);
+        Node* previous = tail_.exchange(&node, std::memory_order_acq_rel);
+        if (previous != nullptr)
+        {
+            previous->next.store(&node, std::memory_order_release);
+            Backoff backoff;
+            while (node.locked.load(std::memory_order_acquire))
+            {
+                backoff.Pause();
+            }
+        }
+    }
+
+    void unlock(Node& node)
+    {
+        Node* next = node.next.load(std::memory_order_acquire);
+        if (next == nullptr)
+        {
+            Node* expected = &node;
+            if (tail_.compare_exchange_strong(expected, nullptr, std::memory_order_release))
+            {
+                return;
+            }
+            //a thread is enqueuing itself, wait for its link
+            Backoff backoff;
+            while ((next = node.next.load(std::memory_order_acquire)) == nullptr)
+            {
+                backoff.Pause();
+            }
+        }
+        next->locked.store(false, std::memory_order_release);
+    }
+
+private:
+    static constexpr std::size_t maxHeldLocks = 8;
+    struct NodePool
+    {
+        std::array<Node, maxHeldLocks> nodes;
+        std::uint32_t usedMask = 0;
+    };
+
+    static Node* AcquireNode()
+    {
+        auto& pool = ThreadNodePool();
+        for (std::size_t i = 0; i < maxHeldLocks; i++)
+        {
+            if ((pool.usedMask & (1u << i)) == 0)
+            {
+                pool.usedMask |= 1u << i;
+                return &pool.nodes[i];
+            }
+        }
+        return new Node();
+    }
+
+    static void ReleaseNode(Node* node)
+    {
+        auto& pool = ThreadNodePool();
+        const auto address = reinterpret_cast<std::uintptr_t>(node);
+        const auto first = reinterpret_cast<std::uintptr_t>(pool.nodes.data());
+        if (address - first >= sizeof(pool.nodes)) [[unlikely]]
+        {
+            delete node;
+            return;
+        }
+        pool.usedMask &= ~(1u << static_cast<std::uint32_t>(node - pool.nodes.data()));
+    }
+
+    static NodePool& ThreadNodePool()
+    {
+        thread_local NodePool pool;
+        return pool;
+    }
+
+    alignas(64) std::atomic<Node*> tail_{nullptr};
+    Node* owner_ = nullptr;
+};
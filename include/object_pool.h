@@ -0,0 +1,207 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+//Handle to an object of an ObjectPool, stays valid while the object lives and turns stale when it is destroyed,
+//even if its slot is reused later: the generation of the slot no longer matches.
+struct PoolHandle
+{
+    static constexpr std::uint32_t invalidIndex = 0xFFFFFFFFu;
+    std::uint32_t index = invalidIndex;
+    std::uint32_t generation = 0;
+
+    bool operator==(const PoolHandle& other) const = default;
+};
+
+//Objects of type T constructed in place in fixed size chunks, no heap allocation per object.
+//The live objects are packed at the start of the storage: iterating them is a linear walk over contiguous
+//memory, destroying one moves the last object in the hole (T must be move constructible).
+//Objects can therefore move, keep a PoolHandle instead of a pointer; a new chunk never moves the others.
+template<typename T, std::size_t chunkSize = 256>
+class ObjectPool
+{
+public:
+    using Handle = PoolHandle;
+
+    template<bool isConst>
+    class Iterator
+    {
+    public:
+        using Pool = std::conditional_t<isConst, const ObjectPool, ObjectPool>;
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = T;
+        using reference = std::conditional_t<isConst, const T&, T&>;
+        using pointer = std::conditional_t<isConst, const T*, T*>;
+        using difference_type = std::ptrdiff_t;
+
+        Iterator() = default;
+        Iterator(Pool* pool, std::size_t index) : pool_(pool), index_(index) {}
+        reference operator*() const { return pool_->At(index_); }
+        pointer operator->() const { return &pool_->At(index_); }
+        Iterator& operator++()
+        {
+            index_++;
+            return *this;
+        }
+        Iterator operator++(int)
+        {
+            Iterator previous = *this;
+            index_++;
+            return previous;
+        }
+        bool operator==(const Iterator& other) const { return index_ == other.index_; }
+    private:
+        Pool* pool_ = nullptr;
+        std::size_t index_ = 0;
+    };
+
+    ObjectPool() = default;
+    ~ObjectPool() { Clear(); }
+    ObjectPool(const ObjectPool&) = delete;
+    ObjectPool& operator=(const ObjectPool&) = delete;
+
+    //allocate the chunks and bookkeeping for count objects, Create does not touch the heap until then
+    void Reserve(std::size_t count)
+    {
+        while (chunks_.size() * chunkSize < count)
+        {
+            chunks_.push_back(std::make_unique_for_overwrite<Chunk>());
+        }
+        slots_.reserve(count);
+        denseToSlot_.reserve(count);
+    }
+
+    template<typename... Args>
+    Handle Create(Args&&... args)
+    {
+        const std::size_t dense = denseToSlot_.size();
+        if (dense == chunks_.size() * chunkSize)
+        {
+            chunks_.push_back(std::make_unique_for_overwrite<Chunk>());
+        }
+        std::uint32_t slot;
+        if (freeSlot_ != Handle::invalidIndex)
+        {
+            //free slots are linked through their dense index
+            slot = freeSlot_;
+            freeSlot_ = slots_[slot].dense;
+        }
+        else
+        {
+            slot = static_cast<std::uint32_t>(slots_.size());
+            slots_.push_back({});
+        }
+        new (Address(dense)) T(std::forward<Args>(args)...);
+        slots_[slot].dense = static_cast<std::uint32_t>(dense);
+        denseToSlot_.push_back(slot);
+        return { slot, slots_[slot].generation };
+    }
+
+    //Returns false if the handle is stale
+    bool Destroy(Handle handle)
+    {
+        if (!IsValid(handle))
+            return false;
+        Slot& slot = slots_[handle.index];
+        const std::size_t dense = slot.dense;
+        const std::size_t last = denseToSlot_.size() - 1;
+        if (dense != last)
+        {
+            //fill the hole with the last object
+            At(dense).~T();
+            new (Address(dense)) T(std::move(At(last)));
+            const std::uint32_t movedSlot = denseToSlot_[last];
+            slots_[movedSlot].dense = static_cast<std::uint32_t>(dense);
+            denseToSlot_[dense] = movedSlot;
+        }
+        At(last).~T();
+        denseToSlot_.pop_back();
+
+        slot.generation++;
+        slot.dense = freeSlot_;
+        freeSlot_ = handle.index;
+        return true;
+    }
+
+    [[nodiscard]] bool IsValid(Handle handle) const
+    {
+        return handle.index < slots_.size() && slots_[handle.index].generation == handle.generation &&
+               slots_[handle.index].dense < denseToSlot_.size() && denseToSlot_[slots_[handle.index].dense] == handle.index;
+    }
+
+    //nullptr if the handle is stale, the pointer is valid until the next Create or Destroy
+    [[nodiscard]] T* Get(Handle handle) { return IsValid(handle) ? &At(slots_[handle.index].dense) : nullptr; }
+    [[nodiscard]] const T* Get(Handle handle) const { return IsValid(handle) ? &At(slots_[handle.index].dense) : nullptr; }
+
+    //handle of the object at position index of the iteration
+    [[nodiscard]] Handle GetHandle(std::size_t index) const
+    {
+        const std::uint32_t slot = denseToSlot_[index];
+        return { slot, slots_[slot].generation };
+    }
+
+    void Clear()
+    {
+        while (!denseToSlot_.empty())
+        {
+            Destroy(GetHandle(denseToSlot_.size() - 1));
+        }
+    }
+
+    [[nodiscard]] std::size_t size() const { return denseToSlot_.size(); }
+    [[nodiscard]] bool empty() const { return denseToSlot_.empty(); }
+    [[nodiscard]] std::size_t capacity() const { return chunks_.size() * chunkSize; }
+
+    Iterator<false> begin() { return { this, 0 }; }
+    Iterator<false> end() { return { this, size() }; }
+    Iterator<true> begin() const { return { this, 0 }; }
+    Iterator<true> end() const { return { this, size() }; }
+
+    //call f on every live object, chunk by chunk
+    template<typename F>
+    void ForEach(F&& f)
+    {
+        std::size_t remaining = size();
+        for (std::size_t chunk = 0; remaining > 0; chunk++)
+        {
+            const std::size_t count = remaining < chunkSize ? remaining : chunkSize;
+            T* objects = std::launder(reinterpret_cast<T*>(chunks_[chunk]->storage));
+            for (std::size_t i = 0; i < count; i++)
+            {
+                f(objects[i]);
+            }
+            remaining -= count;
+        }
+    }
+
+private:
+    struct Chunk
+    {
+        alignas(T) std::byte storage[sizeof(T) * chunkSize];
+    };
+    struct Slot
+    {
+        //position in the dense storage, next free slot when the slot is free
+        std::uint32_t dense = Handle::invalidIndex;
+        std::uint32_t generation = 0;
+    };
+
+    void* Address(std::size_t index) const
+    {
+        return chunks_[index / chunkSize]->storage + (index % chunkSize) * sizeof(T);
+    }
+    T& At(std::size_t index) { return *std::launder(static_cast<T*>(Address(index))); }
+    const T& At(std::size_t index) const { return *std::launder(static_cast<const T*>(Address(index))); }
+
+    std::vector<std::unique_ptr<Chunk>> chunks_;
+    std::vector<Slot> slots_;
+    std::vector<std::uint32_t> denseToSlot_;
+    std::uint32_t freeSlot_ = Handle::invalidIndex;
+};
@@ -0,0 +1,164 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+
+namespace JobSystem
+{
+	//Lock : any type with lock/unlock, std::mutex or one of the spinning locks of locks.h
+	template <typename T,size_t capacity, typename Lock = std::mutex>
+	class ThreadSafeRingBuffer
+	{
+	public:
+		//	Push an item to the end if there is free space
+		//  Returns true if succesful
+		//  Returns false if there is not enough space
+		inline bool push_back(const T& item)
+		{
+			bool result = false;
+			lock.lock();
+			size_t next = (head + 1) % capacity;
+			if (next != tail)
+			{
+				data[head] = item;
+				head = next;
+				result = true;
+			}
+			lock.unlock();
+			return result;
+		}
+
+		// Get an item if there are any
+		//  Returns true if succesful
+		//  Returns false if there are no items
+		inline bool pop_front(T& item)
+		{
+			bool result = false;
+			lock.lock();
+			if (tail != head)
+			{
+				item = data[tail];
+				tail = (tail + 1) % capacity;
+				result = true;
+ 			}
+			lock.unlock();
+			return result;
+		}
+
+		//number of items waiting, already outdated when read by another thread
+		inline size_t size()
+		{
+			lock.lock();
+			const size_t count = (head + capacity - tail) % capacity;
+			lock.unlock();
+			return count;
+		}
+
+	private:
+		Lock lock;
+		size_t tail = 0;
+		size_t head = 0;
+		T data[capacity];
+	};
+
+	//Wait free bounded queue between exactly one producer thread and one consumer thread.
+	//head is only written by the producer, tail only by the consumer. Each side keeps a cached copy of
+	//the other index on its own cache line and only reloads the shared one when the cache says full/empty.
+	//capacity must be a power of two, all of it is usable.
+	template <typename T, size_t capacity>
+	class SpscRingBuffer
+	{
+		static_assert(capacity > 0 && (capacity & (capacity - 1)) == 0, "capacity must be a power of two");
+	public:
+		//	Producer only. Push an item to the end if there is free space
+		//  Returns false if the queue is full
+		inline bool push_back(const T& item)
+		{
+			const size_t currentHead = head.load(std::memory_order_relaxed);
+			if (currentHead - cachedTail == capacity)
+			{
+				cachedTail = tail.load(std::memory_order_acquire);
+				if (currentHead - cachedTail == capacity)
+				{
+					return false;
+				}
+			}
+			data[currentHead & mask] = item;
+			head.store(currentHead + 1, std::memory_order_release);
+			return true;
+		}
+
+		//  Producer only. Push as many of the count items as there is free space for, with one publication
+		//  Returns the number of items pushed
+		inline size_t push_back(const T* items, size_t count)
+		{
+			const size_t currentHead = head.load(std::memory_order_relaxed);
+			if (capacity - (currentHead - cachedTail) < count)
+			{
+				cachedTail = tail.load(std::memory_order_acquire);
+			}
+			const size_t pushed = std::min(count, capacity - (currentHead - cachedTail));
+			for (size_t i = 0; i < pushed; i++)
+			{
+				data[(currentHead + i) & mask] = items[i];
+			}
+			head.store(currentHead + pushed, std::memory_order_release);
+			return pushed;
+		}
+
+		//  Consumer only. Get an item if there are any
+		//  Returns false if the queue is empty
+		inline bool pop_front(T& item)
+		{
+			const size_t currentTail = tail.load(std::memory_order_relaxed);
+			if (currentTail == cachedHead)
+			{
+				cachedHead = head.load(std::memory_order_acquire);
+				if (currentTail == cachedHead)
+				{
+					return false;
+				}
+			}
+			item = std::move(data[currentTail & mask]);
+			tail.store(currentTail + 1, std::memory_order_release);
+			return true;
+		}
+
+		//  Consumer only. Get up to maxCount items, with one publication
+		//  Returns the number of items popped
+		inline size_t pop_front(T* items, size_t maxCount)
+		{
+			const size_t currentTail = tail.load(std::memory_order_relaxed);
+			if (cachedHead - currentTail < maxCount)
+			{
+				cachedHead = head.load(std::memory_order_acquire);
+			}
+			const size_t popped = std::min(maxCount, cachedHead - currentTail);
+			for (size_t i = 0; i < popped; i++)
+			{
+				items[i] = std::move(data[(currentTail + i) & mask]);
+			}
+			tail.store(currentTail + popped, std::memory_order_release);
+			return popped;
+		}
+
+		//number of items waiting, already outdated when read by another thread
+		inline size_t size() const
+		{
+			return head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire);
+		}
+
+	private:
+		static constexpr size_t mask = capacity - 1;
+		static constexpr size_t cacheLineSize = 64;
+
+		//producer cache line
+		alignas(cacheLineSize) std::atomic<size_t> head{ 0 };
+		size_t cachedTail = 0;
+		//consumer cache line
+		alignas(cacheLineSize) std::atomic<size_t> tail{ 0 };
+		size_t cachedHead = 0;
+		alignas(cacheLineSize) T data[capacity];
+	};
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+//Index of the calling thread, given on its first call.
+//Shared by all the sharded structures so a thread always lands on the same shard.
+inline std::size_t ThreadShardIndex()
+{
+    static std::atomic<std::size_t> nextIndex{0};
+    thread_local const std::size_t index = nextIndex.fetch_add(1, std::memory_order_relaxed);
+    return index;
+}
+
+//Counter split in one cache line per thread: increments never contend, Read sums the shards.
+//Threads past maxShards share a shard, still correct but they contend again.
+template<typename T, std::size_t maxShards = 64>
+class ShardedCounter
+{
+public:
+    ShardedCounter() = default;
+    explicit ShardedCounter(T initialValue)
+    {
+        slots_[0].value.store(initialValue, std::memory_order_relaxed);
+    }
+
+    void Increment(T value = T(1))
+    {
+        Increment(ThreadShardIndex(), value);
+    }
+
+    //explicit shard, for callers that already know their index (worker id, benchmark thread...)
+    void Increment(std::size_t shard, T value)
+    {
+        slots_[shard % maxShards].value.fetch_add(value, std::memory_order_release);
+    }
+
+    void Decrement(T value = T(1))
+    {
+        Increment(ThreadShardIndex(), -value);
+    }
+
+    //sum of the shards, exact when no thread is incrementing
+    //a Read that sees an increment also sees what the incrementing thread wrote before it
+    [[nodiscard]] T Read() const
+    {
+        T total{};
+        for (const auto& slot : slots_)
+        {
+            total += slot.value.load(std::memory_order_acquire);
+        }
+        return total;
+    }
+
+    void Reset()
+    {
+        for (auto& slot : slots_)
+        {
+            slot.value.store(T{}, std::memory_order_relaxed);
+        }
+    }
+
+private:
+    struct alignas(64) Slot
+    {
+        std::atomic<T> value{};
+    };
+    std::array<Slot, maxShards> slots_;
+};
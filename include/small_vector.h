@@ -0,0 +1,322 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <initializer_list>
+#include <memory>
+#include <new>
+#include <utility>
+
+//Vector of at most N elements stored inside the object, never allocates.
+//Adding past the capacity fails and leaves the vector unchanged, check the result of push_back and emplace_back.
+//For the short lists of known maximum size, kept on the stack or in the owner object.
+template<typename T, std::size_t N>
+class InplaceVector
+{
+public:
+    static_assert(N > 0, "an empty InplaceVector can't hold anything");
+
+    using value_type = T;
+    using iterator = T*;
+    using const_iterator = const T*;
+
+    InplaceVector() = default;
+    InplaceVector(std::initializer_list<T> values)
+    {
+        for (const auto& value : values)
+        {
+            push_back(value);
+        }
+    }
+    InplaceVector(const InplaceVector& other)
+    {
+        std::uninitialized_copy(other.begin(), other.end(), data());
+        size_ = other.size_;
+    }
+    InplaceVector(InplaceVector&& other) noexcept
+    {
+        std::uninitialized_move(other.begin(), other.end(), data());
+        size_ = other.size_;
+        other.clear();
+    }
+    InplaceVector& operator=(const InplaceVector& other)
+    {
+        if (this != &other)
+        {
+            clear();
+            std::uninitialized_copy(other.begin(), other.end(), data());
+            size_ = other.size_;
+        }
+        return *this;
+    }
+    InplaceVector& operator=(InplaceVector&& other) noexcept
+    {
+        if (this != &other)
+        {
+            clear();
+            std::uninitialized_move(other.begin(), other.end(), data());
+            size_ = other.size_;
+            other.clear();
+        }
+        return *this;
+    }
+    ~InplaceVector() { clear(); }
+
+    //Returns false if the vector is full
+    template<typename... Args>
+    bool emplace_back(Args&&... args)
+    {
+        if (size_ == N) [[unlikely]]
+            return false;
+        new (data() + size_) T(std::forward<Args>(args)...);
+        size_++;
+        return true;
+    }
+    bool push_back(const T& value) { return emplace_back(value); }
+    bool push_back(T&& value) { return emplace_back(std::move(value)); }
+
+    void pop_back()
+    {
+        size_--;
+        data()[size_].~T();
+    }
+
+    //keeps the order, returns the position after the erased element
+    iterator erase(const_iterator position)
+    {
+        T* element = begin() + (position - begin());
+        std::move(element + 1, end(), element);
+        pop_back();
+        return element;
+    }
+
+    void clear()
+    {
+        std::destroy(begin(), end());
+        size_ = 0;
+    }
+
+    [[nodiscard]] T* data() { return reinterpret_cast<T*>(storage_); }
+    [[nodiscard]] const T* data() const { return reinterpret_cast<const T*>(storage_); }
+    T& operator[](std::size_t index) { return data()[index]; }
+    const T& operator[](std::size_t index) const { return data()[index]; }
+    T& front() { return data()[0]; }
+    const T& front() const { return data()[0]; }
+    T& back() { return data()[size_ - 1]; }
+    const T& back() const { return data()[size_ - 1]; }
+
+    [[nodiscard]] std::size_t size() const { return size_; }
+    [[nodiscard]] bool empty() const { return size_ == 0; }
+    [[nodiscard]] bool full() const { return size_ == N; }
+    [[nodiscard]] static constexpr std::size_t capacity() { return N; }
+
+    iterator begin() { return data(); }
+    iterator end() { return data() + size_; }
+    const_iterator begin() const { return data(); }
+    const_iterator end() const { return data() + size_; }
+
+private:
+    alignas(T) std::byte storage_[sizeof(T) * N];
+    std::size_t size_ = 0;
+};
+
+//Vector keeping its first N elements inside the object, it only allocates on the heap past N elements
+//(then grows like std::vector and never goes back to the inline storage, clear keeps the heap buffer).
+//Moving an inline SmallVector moves the elements one by one, moving a spilled one steals the heap buffer.
+template<typename T, std::size_t N>
+class SmallVector
+{
+public:
+    static_assert(N > 0, "use std::vector without inline storage");
+
+    using value_type = T;
+    using iterator = T*;
+    using const_iterator = const T*;
+
+    SmallVector() = default;
+    SmallVector(std::initializer_list<T> values)
+    {
+        reserve(values.size());
+        std::uninitialized_copy(values.begin(), values.end(), data_);
+        size_ = values.size();
+    }
+    SmallVector(const SmallVector& other)
+    {
+        reserve(other.size_);
+        std::uninitialized_copy(other.begin(), other.end(), data_);
+        size_ = other.size_;
+    }
+    SmallVector(SmallVector&& other) noexcept
+    {
+        MoveFrom(std::move(other));
+    }
+    SmallVector& operator=(const SmallVector& other)
+    {
+        if (this != &other)
+        {
+            clear();
+            reserve(other.size_);
+            std::uninitialized_copy(other.begin(), other.end(), data_);
+            size_ = other.size_;
+        }
+        return *this;
+    }
+    SmallVector& operator=(SmallVector&& other) noexcept
+    {
+        if (this != &other)
+        {
+            clear();
+            Release();
+            MoveFrom(std::move(other));
+        }
+        return *this;
+    }
+    ~SmallVector()
+    {
+        clear();
+        Release();
+    }
+
+    template<typename... Args>
+    T& emplace_back(Args&&... args)
+    {
+        if (size_ == capacity_) [[unlikely]]
+        {
+            return GrowAndEmplaceBack(std::forward<Args>(args)...);
+        }
+        T* element = new (data_ + size_) T(std::forward<Args>(args)...);
+        size_++;
+        return *element;
+    }
+    void push_back(const T& value) { emplace_back(value); }
+    void push_back(T&& value) { emplace_back(std::move(value)); }
+
+    void pop_back()
+    {
+        size_--;
+        data_[size_].~T();
+    }
+
+    //keeps the order, returns the position after the erased element
+    iterator erase(const_iterator position)
+    {
+        T* element = data_ + (position - data_);
+        std::move(element + 1, end(), element);
+        pop_back();
+        return element;
+    }
+
+    void reserve(std::size_t capacity)
+    {
+        if (capacity > capacity_)
+        {
+            T* newData = Allocate(capacity);
+            MoveElements(newData);
+            Release();
+            data_ = newData;
+            capacity_ = capacity;
+        }
+    }
+
+    void resize(std::size_t size)
+    {
+        if (size < size_)
+        {
+            std::destroy(data_ + size, end());
+        }
+        else
+        {
+            reserve(size);
+            std::uninitialized_value_construct(data_ + size_, data_ + size);
+        }
+        size_ = size;
+    }
+
+    void clear()
+    {
+        std::destroy(begin(), end());
+        size_ = 0;
+    }
+
+    [[nodiscard]] T* data() { return data_; }
+    [[nodiscard]] const T* data() const { return data_; }
+    T& operator[](std::size_t index) { return data_[index]; }
+    const T& operator[](std::size_t index) const { return data_[index]; }
+    T& front() { return data_[0]; }
+    const T& front() const { return data_[0]; }
+    T& back() { return data_[size_ - 1]; }
+    const T& back() const { return data_[size_ - 1]; }
+
+    [[nodiscard]] std::size_t size() const { return size_; }
+    [[nodiscard]] bool empty() const { return size_ == 0; }
+    [[nodiscard]] std::size_t capacity() const { return capacity_; }
+    //false once the elements spilled to the heap
+    [[nodiscard]] bool IsInline() const { return data_ == InlineData(); }
+
+    iterator begin() { return data_; }
+    iterator end() { return data_ + size_; }
+    const_iterator begin() const { return data_; }
+    const_iterator end() const { return data_ + size_; }
+
+private:
+    static T* Allocate(std::size_t capacity)
+    {
+        return static_cast<T*>(::operator new(capacity * sizeof(T), std::align_val_t(alignof(T))));
+    }
+
+    //free the heap buffer, the elements are already destroyed or moved
+    void Release()
+    {
+        if (!IsInline())
+        {
+            ::operator delete(data_, std::align_val_t(alignof(T)));
+            data_ = InlineData();
+            capacity_ = N;
+        }
+    }
+
+    void MoveElements(T* destination)
+    {
+        std::uninitialized_move(begin(), end(), destination);
+        std::destroy(begin(), end());
+    }
+
+    template<typename... Args>
+    T& GrowAndEmplaceBack(Args&&... args)
+    {
+        const std::size_t newCapacity = std::max<std::size_t>(2 * capacity_, 1);
+        T* newData = Allocate(newCapacity);
+        //built before the elements move, args can refer to one of them
+        T* element = new (newData + size_) T(std::forward<Args>(args)...);
+        MoveElements(newData);
+        Release();
+        data_ = newData;
+        capacity_ = newCapacity;
+        size_++;
+        return *element;
+    }
+
+    void MoveFrom(SmallVector&& other)
+    {
+        if (other.IsInline())
+        {
+            std::uninitialized_move(other.begin(), other.end(), data_);
+            size_ = other.size_;
+            other.clear();
+        }
+        else
+        {
+            data_ = std::exchange(other.data_, other.InlineData());
+            capacity_ = std::exchange(other.capacity_, N);
+            size_ = std::exchange(other.size_, 0);
+        }
+    }
+
+    T* InlineData() { return reinterpret_cast<T*>(storage_); }
+    const T* InlineData() const { return reinterpret_cast<const T*>(storage_); }
+
+    T* data_ = InlineData();
+    std::size_t size_ = 0;
+    std::size_t capacity_ = N;
+    alignas(T) std::byte storage_[sizeof(T) * N];
+};
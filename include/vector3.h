@@ -68,9 +68,9 @@ public:
 
     [[nodiscard]] std::array<Vec3f, N> vectors() const;
 private:
-    std::array<float, N> xs{};
-    std::array<float, N> ys{};
-    std::array<float, N> zs{};
+    alignas(floatArrayAlignment<N>) std::array<float, N> xs{};
+    alignas(floatArrayAlignment<N>) std::array<float, N> ys{};
+    alignas(floatArrayAlignment<N>) std::array<float, N> zs{};
 };
 
 template<std::size_t N>
@@ -4,7 +4,8 @@
 namespace maths
 {
 
-union Vec4f
+//aligned on a SSE register, Mat4f::MultIntrinsics loads its columns with _mm_load_ps
+union alignas(16) Vec4f
 {
     struct
     {
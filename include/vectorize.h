@@ -12,6 +12,11 @@
 
 namespace maths
 {
+//N floats filling whole SSE/AVX registers are aligned on them, the kernels use aligned loads and stores
+template<std::size_t N>
+constexpr std::size_t floatArrayAlignment =
+    (N * sizeof(float)) % 16 == 0 ? ((N * sizeof(float)) % 32 == 0 ? 32 : 16) : alignof(float);
+
 template<std::size_t N>
 class FloatArray
 {
@@ -38,7 +43,7 @@ public:
 
     [[nodiscard]] const std::array<float, N>& array() const {return values_;}
 private:
-    std::array<float, N> values_;
+    alignas(floatArrayAlignment<N>) std::array<float, N> values_;
 };
 
 template<std::size_t N>
@@ -125,35 +130,35 @@ using EightFloat = FloatArray<8>;
 template<>
 inline FourFloat FourFloat::Sqrt(const FloatArray<4>& rhs)
 {
-    auto vs = _mm_loadu_ps(&rhs[0]);
+    auto vs = _mm_load_ps(&rhs[0]);
     vs = _mm_sqrt_ps(vs);
 
     FourFloat result;
-    _mm_storeu_ps(&result[0], vs);
+    _mm_store_ps(&result[0], vs);
     return result;
 }
 
 template<>
 inline FourFloat FourFloat::operator*(const FloatArray<4>& rhs) const
 {
-    auto v1s = _mm_loadu_ps(values_.data());
-    auto v2s = _mm_loadu_ps(rhs.values_.data());
+    auto v1s = _mm_load_ps(values_.data());
+    auto v2s = _mm_load_ps(rhs.values_.data());
     v1s = _mm_mul_ps(v1s, v2s);
 
     FourFloat result;
-    _mm_storeu_ps(result.values_.data(), v1s);
+    _mm_store_ps(result.values_.data(), v1s);
     return result;
 }
 
 template<>
 inline FourFloat FourFloat::operator*(float rhs) const
 {
-    auto v1s = _mm_loadu_ps(values_.data());
+    auto v1s = _mm_load_ps(values_.data());
     auto v2 = _mm_load1_ps(&rhs);
     v1s = _mm_mul_ps(v1s, v2);
 
     FourFloat result;
-    _mm_storeu_ps(result.values_.data(), v1s);
+    _mm_store_ps(result.values_.data(), v1s);
     return result;
 }
 #endif
@@ -162,35 +167,35 @@ inline FourFloat FourFloat::operator*(float rhs) const
 template<>
 inline EightFloat EightFloat::Sqrt(const EightFloat& rhs)
 {
-    auto vs = _mm256_loadu_ps(rhs.values_.data());
+    auto vs = _mm256_load_ps(rhs.values_.data());
     vs = _mm256_sqrt_ps(vs);
 
     EightFloat result;
-    _mm256_storeu_ps(result.values_.data(), vs);
+    _mm256_store_ps(result.values_.data(), vs);
     return result;
 }
 
 template<>
 inline EightFloat EightFloat::operator*(const EightFloat& rhs) const
 {
-    auto v1s = _mm256_loadu_ps(values_.data());
-    auto v2s = _mm256_loadu_ps(rhs.values_.data());
+    auto v1s = _mm256_load_ps(values_.data());
+    auto v2s = _mm256_load_ps(rhs.values_.data());
     v1s = _mm256_mul_ps(v1s, v2s);
 
     EightFloat result;
-    _mm256_storeu_ps(result.values_.data(), v1s);
+    _mm256_store_ps(result.values_.data(), v1s);
     return result;
 }
 
 template<>
 inline EightFloat EightFloat::operator*(float rhs) const
 {
-    auto v1s = _mm256_loadu_ps(values_.data());
+    auto v1s = _mm256_load_ps(values_.data());
     auto v2 = _mm256_broadcast_ss(&rhs);
     v1s = _mm256_mul_ps(v1s, v2);
 
     EightFloat result;
-    _mm256_storeu_ps(result.values_.data(), v1s);
+    _mm256_store_ps(result.values_.data(), v1s);
     return result;
 }
 #endif
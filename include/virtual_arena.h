@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstddef>
+
+#include "custom_allocator.h"
+
+//Bump allocator over a large reserved range of virtual memory: only address space is taken at creation,
+//pages are committed in chunks as the bump pointer advances. The arena grows without copying and its
+//pointers stay valid until Reset. Deallocate does nothing, like LinearAllocator.
+class VirtualArena final : public Allocator
+{
+public:
+    //reserveSize : upper bound of the arena, rounded up to whole pages
+    //commitChunk : memory committed at once when the arena grows, rounded up to whole pages
+    //hugePages : align the range and the chunks on 2MB and ask for transparent huge pages (linux only,
+    //windows large pages can't be committed on demand)
+    explicit VirtualArena(std::size_t reserveSize, std::size_t commitChunk = 64 * 1024, bool hugePages = false);
+    ~VirtualArena() override;
+    VirtualArena(const VirtualArena&) = delete;
+    VirtualArena& operator=(const VirtualArena&) = delete;
+
+    //Returns nullptr when the reserved range is full or the system refused to commit
+    void* Allocate(std::size_t allocationSize, std::size_t alignment) override;
+    void Deallocate(void* ptr) override;
+    //forget every allocation, releasePages gives the committed pages back to the system
+    //(madvise DONTNEED / decommit), otherwise they are kept for the next allocations
+    void Reset(bool releasePages = false);
+
+    [[nodiscard]] std::size_t GetCommittedMemory() const { return committedSize_; }
+    //whether the range really asked for huge pages: false on windows or when the kernel refused the advice
+    [[nodiscard]] bool UsesHugePages() const { return hugePages_; }
+    [[nodiscard]] static std::size_t GetPageSize();
+private:
+    bool Commit(std::size_t size);
+
+    std::size_t commitChunk_ = 0;
+    std::size_t committedSize_ = 0;
+    std::size_t offset_ = 0;
+    bool hugePages_ = false;
+};
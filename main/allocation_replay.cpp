@@ -0,0 +1,99 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include "allocation_trace.h"
+#include "custom_allocator.h"
+#include "virtual_arena.h"
+
+//Replays a trace recorded with ALLOCATION_TRACKER_TRACE=path or AllocationTracker::StartRecording on every
+//general purpose allocator.
+//usage: allocation_replay trace [heapSizeMB]
+
+static void PrintResult(const char* name, const ReplayResult& result, const AllocationReplay& replay)
+{
+    const std::size_t operations = result.allocations + result.deallocations;
+    std::printf("%-16s %10.3f ms %8.1f ns/op", name, result.seconds * 1e3,
+        operations > 0 ? result.seconds * 1e9 / static_cast<double>(operations) : 0.0);
+    //an empty trace requests nothing
+    if (result.peakMemory > 0 && replay.GetPeakRequestedMemory() > 0)
+    {
+        std::printf(" %10.2f MB peak (%.2fx requested)", static_cast<double>(result.peakMemory) / (1 << 20),
+            static_cast<double>(result.peakMemory) / static_cast<double>(replay.GetPeakRequestedMemory()));
+    }
+    else if (result.peakMemory > 0)
+    {
+        std::printf(" %10.2f MB peak", static_cast<double>(result.peakMemory) / (1 << 20));
+    }
+    else
+    {
+        std::printf(" %10s peak", "-");
+    }
+    std::printf(" %8zu failed\n", result.failedAllocations);
+}
+
+//run replays on a heap of heapSize bytes, only the touched pages are committed
+template<typename Run>
+static void ReplayOnHeap(const char* name, const AllocationReplay& replay, std::size_t heapSize, Run run)
+{
+    VirtualArena arena(heapSize);
+    void* heap = arena.Allocate(heapSize, 64);
+    if (heap == nullptr)
+    {
+        std::printf("%-16s can't reserve the heap\n", name);
+        return;
+    }
+    PrintResult(name, run(heap), replay);
+}
+
+template<typename T>
+static void ReplayOn(const char* name, const AllocationReplay& replay, std::size_t heapSize)
+{
+    ReplayOnHeap(name, replay, heapSize, [&replay, heapSize](void* heap)
+    {
+        T allocator(heap, heapSize);
+        return replay.Run(allocator);
+    });
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 2)
+    {
+        std::printf("usage: %s trace [heapSizeMB]\n", argv[0]);
+        return 1;
+    }
+    std::vector<AllocationTraceRecord> records;
+    if (!LoadAllocationTrace(argv[1], records))
+    {
+        std::printf("can't read the trace %s\n", argv[1]);
+        return 1;
+    }
+    const AllocationReplay replay(records);
+    //by default room for the peak with the headers and the fragmentation of the worst allocator
+    std::size_t heapSize = argc > 2 ? std::strtoull(argv[2], nullptr, 10) << 20 : 4 * replay.GetPeakRequestedMemory();
+    heapSize = std::max<std::size_t>(heapSize, 1 << 20);
+
+    std::printf("%zu records, %zu operations, %zu frees of blocks allocated before the recording\n",
+        records.size(), replay.GetOperationCount(), replay.GetUnknownFreeCount());
+    std::printf("peak requested %.2f MB, max alignment %zu, heap %.2f MB\n",
+        static_cast<double>(replay.GetPeakRequestedMemory()) / (1 << 20), replay.GetMaxAlignment(),
+        static_cast<double>(heapSize) / (1 << 20));
+
+    PrintResult("malloc", replay.RunMalloc(), replay);
+    ReplayOn<FreeListAllocator>("FreeList", replay, heapSize);
+    ReplayOn<TlsfAllocator>("Tlsf", replay, heapSize);
+    ReplayOn<BuddyAllocator>("Buddy", replay, heapSize);
+    ReplayOnHeap("ThreadCaching", replay, heapSize, [&replay, heapSize](void* heap)
+    {
+        //the cache keeps no statistics, the peak is the one of the backing allocator
+        TlsfAllocator backing(heap, heapSize);
+        ThreadCachingAllocator allocator(backing);
+        ReplayResult result = replay.Run(allocator);
+        allocator.FlushThreadCache();
+        result.peakMemory = backing.GetPeakMemory();
+        return result;
+    });
+    return 0;
+}
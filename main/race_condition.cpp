@@ -2,6 +2,8 @@
 #include <thread>
 #include <iostream>
 
+#include "sharded_counter.h"
+
 static constexpr size_t total = 10000;
 
 #ifdef WIN32
@@ -38,13 +40,38 @@ void Wallet::IncMoney()
     mMoney++;
 }
 
+//same wallet with one padded counter per thread, no race and no contention between the threads
+class ShardedWallet
+{
+    ShardedCounter<int> mMoney;
+public:
+    [[nodiscard]] int GetMoney() const
+    {
+        return mMoney.Read();
+    }
+    NOINLINE void IncMoney();
+
+    void AddMoney(size_t money)
+    {
+        for (size_t i = 0; i < money; ++i)
+        {
+            IncMoney();
+        }
+    }
+};
+void ShardedWallet::IncMoney()
+{
+    mMoney.Increment();
+}
+
+template<typename WalletType>
 int TestMultithreadedWallet(int totalThread)
 {
-    Wallet walletObject;
+    WalletType walletObject;
     std::vector<std::thread> threads;
     for (int i = 0; i < totalThread; ++i)
     {
-        threads.push_back(std::thread(&Wallet::AddMoney, &walletObject, total));
+        threads.push_back(std::thread(&WalletType::AddMoney, &walletObject, total));
     }
 
     for (int i = 0; i < threads.size(); i++)
@@ -62,17 +89,23 @@ int main()
     for (int totalThread = 1; totalThread < 8; totalThread++)
     {
         int errorCount = 0;
+        int shardedErrorCount = 0;
         for (size_t k = 0; k < total/totalThread; k++)
         {
-            if ((val = TestMultithreadedWallet(totalThread)) != total * totalThread)
+            if ((val = TestMultithreadedWallet<Wallet>(totalThread)) != total * totalThread)
             {
                 //std::cout << "Error at count = " << k << " Money in Wallet = " << val << std::endl;
                 errorCount++;
             }
+            if (TestMultithreadedWallet<ShardedWallet>(totalThread) != total * totalThread)
+            {
+                shardedErrorCount++;
+            }
 
         }
 
         std::cout << "Total error count: " << errorCount << " over " << total <<" with threads number : " << totalThread << "\n";
+        std::cout << "Sharded wallet error count: " << shardedErrorCount << " over " << total <<" with threads number : " << totalThread << "\n";
     }
     return 0;
 }
\ No newline at end of file
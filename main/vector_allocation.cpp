@@ -1,32 +1,84 @@
+#include <array>
 #include <iostream>
 #include <vector>
 
-static std::size_t allocationCount = 0;
+#include "allocation_tracker.h"
+#include "allocator_resource.h"
+#include "small_vector.h"
 
-void* operator new(std::size_t sz) // no inline, required by [replacement.functions]/3
+//operator new and malloc are replaced by the AllocationTracker target
+static std::size_t AllocationCount()
 {
-    std::cout << "Allocating " << sz << " bytes\n";
-
-    allocationCount++;
-    if (void* ptr = std::malloc(sz))
-        return ptr;
-    return nullptr;
-    //throw std::bad_alloc{}; // required by [new.delete.single]/3
-}
-void operator delete(void* ptr) noexcept
-{
-    std::free(ptr);
+    return AllocationTracker::Get().EndFrame(0).allocations;
 }
 
 int main()
 {
     constexpr int iteration = 1000;
+    AllocationCount();
     std::vector<int> number;
     //number.reserve(iteration);
     for(int i = 0; i < iteration; i++)
     {
         number.push_back(rand());
     }
-    std::cout << "Allocation count: " << allocationCount << '\n';
+    //where they come from
+    const auto report = AllocationTracker::Get().EndFrame(1);
+    std::cout << "Allocation count: " << report.allocations << '\n';
+    AllocationTracker::PrintReport(report);
+
+    //same vector on a FreeListAllocator over a stack buffer, operator new is never called
+    AllocationCount();
+    {
+        alignas(16) static std::array<char, 16 * 1024> buffer;
+        FreeListAllocator allocator(buffer.data(), buffer.size());
+        AllocatorResource resource(allocator, std::pmr::null_memory_resource());
+        std::pmr::vector<int> pmrNumber(&resource);
+        for(int i = 0; i < iteration; i++)
+        {
+            pmrNumber.push_back(rand());
+        }
+    }
+    std::cout << "Allocation count with FreeListAllocator: " << AllocationCount() << '\n';
+
+    //per frame data, the buffer is allocated once then every frame reuses it
+    FrameResource frameResource(16 * 1024);
+    AllocationCount();
+    for(int frame = 0; frame < 10; frame++)
+    {
+        //the containers of the frame are destroyed before the Reset
+        {
+            std::pmr::vector<int> pmrNumber(&frameResource);
+            for(int i = 0; i < iteration; i++)
+            {
+                pmrNumber.push_back(rand());
+            }
+            std::pmr::string text("frame data that does not fit in the small string buffer", &frameResource);
+        }
+        frameResource.Reset();
+    }
+    std::cout << "Allocation count with FrameResource: " << AllocationCount() << '\n';
+
+    //short lists: the inline storage covers the common sizes, only the long ones reach the heap
+    AllocationCount();
+    for(int list = 0; list < iteration; list++)
+    {
+        SmallVector<int, 8> shortList;
+        for(int i = 0; i < list % 12; i++)
+        {
+            shortList.push_back(rand());
+        }
+    }
+    std::cout << "Allocation count for " << iteration << " SmallVector<int, 8>: " << AllocationCount() << '\n';
+
+    AllocationCount();
+    {
+        InplaceVector<int, iteration> inplaceNumber;
+        for(int i = 0; i < iteration; i++)
+        {
+            inplaceNumber.push_back(rand());
+        }
+    }
+    std::cout << "Allocation count with InplaceVector: " << AllocationCount() << '\n';
     return 0;
-}
\ No newline at end of file
+}
@@ -0,0 +1,123 @@
+#include "allocation_trace.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <unordered_map>
+
+bool LoadAllocationTrace(const char* path, std::vector<AllocationTraceRecord>& records)
+{
+    std::FILE* file = std::fopen(path, "rb");
+    if (file == nullptr)
+        return false;
+    AllocationTraceHeader header;
+    const AllocationTraceHeader expected;
+    if (std::fread(&header, sizeof(header), 1, file) != 1 || header.magic != expected.magic ||
+        header.version != expected.version || header.recordSize != expected.recordSize)
+    {
+        std::fclose(file);
+        return false;
+    }
+    records.clear();
+    AllocationTraceRecord chunk[1024];
+    std::size_t read = 0;
+    while ((read = std::fread(chunk, sizeof(AllocationTraceRecord), std::size(chunk), file)) > 0)
+    {
+        records.insert(records.end(), chunk, chunk + read);
+    }
+    std::fclose(file);
+    std::stable_sort(records.begin(), records.end(),
+        [](const AllocationTraceRecord& a, const AllocationTraceRecord& b) { return a.timestamp < b.timestamp; });
+    return true;
+}
+
+AllocationReplay::AllocationReplay(std::span<const AllocationTraceRecord> records)
+{
+    operations_.reserve(records.size());
+    std::unordered_map<std::uint64_t, std::pair<std::uint32_t, std::uint32_t>> liveBlocks;
+    std::size_t requestedMemory = 0;
+    for (const auto& record : records)
+    {
+        if (record.event == AllocationEvent::Allocate)
+        {
+            const auto block = static_cast<std::uint32_t>(blockCount_++);
+            const std::size_t alignment = std::size_t(1) << record.alignmentLog2;
+            maxAlignment_ = std::max(maxAlignment_, alignment);
+            //an address given again without a free in between: the free was not recorded, the old block
+            //stays allocated until the end of the replay
+            auto [it, inserted] = liveBlocks.try_emplace(record.address, block, record.size);
+            if (!inserted)
+            {
+                requestedMemory -= it->second.second;
+                it->second = { block, record.size };
+            }
+            operations_.push_back({ block, record.size, static_cast<std::uint32_t>(alignment), true });
+            requestedMemory += record.size;
+            peakRequestedMemory_ = std::max(peakRequestedMemory_, requestedMemory);
+        }
+        else
+        {
+            auto it = liveBlocks.find(record.address);
+            if (it == liveBlocks.end())
+            {
+                unknownFrees_++;
+                continue;
+            }
+            operations_.push_back({ it->second.first, 0, 0, false });
+            requestedMemory -= it->second.second;
+            liveBlocks.erase(it);
+        }
+    }
+}
+
+template<typename Allocate, typename Deallocate>
+ReplayResult AllocationReplay::Replay(Allocate allocate, Deallocate deallocate) const
+{
+    ReplayResult result;
+    std::vector<void*> blocks(blockCount_, nullptr);
+    const auto start = std::chrono::steady_clock::now();
+    for (const auto& operation : operations_)
+    {
+        if (operation.allocate)
+        {
+            void* ptr = allocate(operation.size, operation.alignment);
+            blocks[operation.block] = ptr;
+            if (ptr == nullptr) [[unlikely]]
+                result.failedAllocations++;
+            else
+                result.allocations++;
+        }
+        else if (void* ptr = blocks[operation.block])
+        {
+            deallocate(ptr);
+            blocks[operation.block] = nullptr;
+            result.deallocations++;
+        }
+    }
+    const auto end = std::chrono::steady_clock::now();
+    result.seconds = std::chrono::duration<double>(end - start).count();
+    for (void* ptr : blocks)
+    {
+        if (ptr != nullptr)
+            deallocate(ptr);
+    }
+    return result;
+}
+
+ReplayResult AllocationReplay::Run(Allocator& allocator) const
+{
+    ReplayResult result = Replay(
+        [&allocator](std::size_t size, std::size_t alignment) { return allocator.Allocate(size, alignment); },
+        [&allocator](void* ptr) { allocator.Deallocate(ptr); });
+    result.peakMemory = allocator.GetPeakMemory();
+    return result;
+}
+
+ReplayResult AllocationReplay::RunMalloc() const
+{
+    //the over aligned blocks are not honored, the replay never touches the memory
+    return Replay(
+        [](std::size_t size, std::size_t) { return std::malloc(size); },
+        [](void* ptr) { std::free(ptr); });
+}
@@ -0,0 +1,647 @@
+#include "allocation_tracker.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cinttypes>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#include <utility>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <Windows.h>
+#include <DbgHelp.h>
+#include <malloc.h>
+#define NOINLINE __declspec(noinline)
+#define FORCEINLINE __forceinline
+#else
+#include <cxxabi.h>
+#include <dlfcn.h>
+#include <execinfo.h>
+#define NOINLINE __attribute__ ((noinline))
+#define FORCEINLINE inline __attribute__ ((always_inline))
+#endif
+
+#ifdef __GLIBC__
+//the real glibc allocator, the malloc family below is replaced
+extern "C"
+{
+    void* __libc_malloc(std::size_t size) noexcept;
+    void* __libc_calloc(std::size_t count, std::size_t size) noexcept;
+    void* __libc_realloc(void* ptr, std::size_t size) noexcept;
+    void* __libc_memalign(std::size_t alignment, std::size_t size) noexcept;
+    void __libc_free(void* ptr) noexcept;
+}
+#endif
+
+namespace
+{
+    //trivial so it is usable from the first allocation of a thread
+    struct ThreadState
+    {
+        //set while the tracker runs: its own allocations (tables, backtrace, reports) are not tracked
+        bool inTracker = false;
+        //the thread gave its slot back, the allocations of its last destructors are not tracked
+        bool exited = false;
+        std::uint32_t untilSample = 0;
+    };
+    thread_local ThreadState threadState;
+
+    class ReentryGuard
+    {
+    public:
+        ReentryGuard() : previous_(threadState.inTracker) { threadState.inTracker = true; }
+        ~ReentryGuard() { threadState.inTracker = previous_; }
+    private:
+        bool previous_;
+    };
+
+    //RecordSample, OnAllocation and the hook, the helpers of the hooks are always inlined
+    constexpr int skippedFrames = 3;
+
+    //only the owner of the slot writes, no need for a locked add
+    void Add(std::atomic<std::uint64_t>& counter, std::uint64_t value)
+    {
+        counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+    }
+
+    std::uint64_t HashFrames(void* const* frames, int depth)
+    {
+        //FNV-1a over the return addresses
+        std::uint64_t hash = 14695981039346656037ull;
+        for (int i = 0; i < depth; i++)
+        {
+            hash = (hash ^ reinterpret_cast<std::uintptr_t>(frames[i])) * 1099511628211ull;
+        }
+        return hash == 0 ? 1 : hash;
+    }
+
+    void PrintExitReport();
+    void StopExitRecording();
+    std::size_t exitReportCount = 0;
+
+    //ALLOCATION_TRACKER_REPORT=count prints the top callsites when the program exits,
+    //ALLOCATION_TRACKER_TRACE=path records the allocations from here to the exit
+    struct ExitReport
+    {
+        ExitReport()
+        {
+            if (const char* value = std::getenv("ALLOCATION_TRACKER_REPORT"))
+            {
+                exitReportCount = std::strtoull(value, nullptr, 10);
+                std::atexit(PrintExitReport);
+            }
+            if (const char* path = std::getenv("ALLOCATION_TRACKER_TRACE"))
+            {
+                if (AllocationTracker::Get().StartRecording(path))
+                    std::atexit(StopExitRecording);
+            }
+        }
+    };
+    ExitReport exitReport;
+
+    void PrintExitReport()
+    {
+        AllocationTracker::PrintReport(AllocationTracker::Get().GetTotalReport(exitReportCount), stderr);
+    }
+
+    void StopExitRecording()
+    {
+        AllocationTracker::Get().StopRecording();
+    }
+
+    std::uint8_t AlignmentLog2(std::size_t alignment)
+    {
+        std::uint8_t log2 = 0;
+        while ((std::size_t(2) << log2) <= alignment)
+        {
+            log2++;
+        }
+        return log2;
+    }
+}
+
+thread_local AllocationTracker::ThreadSlot AllocationTracker::threadSlot_;
+
+AllocationTracker::ThreadSlot::~ThreadSlot()
+{
+    threadState.exited = true;
+    if (slot != nullptr)
+    {
+        slot->inUse.store(false, std::memory_order_release);
+        slot = nullptr;
+    }
+}
+
+AllocationTracker& AllocationTracker::Get()
+{
+    //constant initialized, usable by the allocations made before main
+    static constinit AllocationTracker tracker;
+    return tracker;
+}
+
+AllocationTracker::Slot* AllocationTracker::GetSlot()
+{
+    if (threadSlot_.slot != nullptr || threadState.exited)
+    {
+        return threadSlot_.slot;
+    }
+    for (auto& slot : slots_)
+    {
+        bool expected = false;
+        if (slot.inUse.compare_exchange_strong(expected, true, std::memory_order_acq_rel))
+        {
+            threadSlot_.slot = &slot;
+            return &slot;
+        }
+    }
+    //never wait in an allocation, the thread stays untracked
+    return nullptr;
+}
+
+NOINLINE void AllocationTracker::OnAllocation(void* ptr, std::size_t size, std::size_t alignment)
+{
+    ThreadState& state = threadState;
+    if (state.inTracker || !enabled_.load(std::memory_order_relaxed))
+    {
+        return;
+    }
+    ReentryGuard guard;
+    Slot* slot = GetSlot();
+    if (slot == nullptr) [[unlikely]]
+    {
+        untrackedAllocations_.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    Add(slot->allocations, 1);
+    Add(slot->bytes, size);
+    if (recording_.load(std::memory_order_acquire))
+    {
+        RecordEvent(*slot, AllocationEvent::Allocate, ptr, size, alignment);
+    }
+    if (state.untilSample > 1)
+    {
+        state.untilSample--;
+        return;
+    }
+    const std::uint32_t rate = sampleRate_.load(std::memory_order_relaxed);
+    if (rate != 0)
+    {
+        state.untilSample = rate;
+        RecordSample(*slot, size, rate);
+    }
+}
+
+void AllocationTracker::OnDeallocation(void* ptr, std::chrono::steady_clock::time_point time)
+{
+    if (threadState.inTracker || !enabled_.load(std::memory_order_relaxed))
+    {
+        return;
+    }
+    ReentryGuard guard;
+    if (Slot* slot = GetSlot())
+    {
+        Add(slot->deallocations, 1);
+        if (recording_.load(std::memory_order_acquire))
+        {
+            RecordEvent(*slot, AllocationEvent::Deallocate, ptr, 0, 0, time);
+        }
+    }
+}
+
+NOINLINE void AllocationTracker::RecordSample(Slot& slot, std::size_t size, std::uint32_t rate)
+{
+    void* stack[maxFrames + skippedFrames];
+#ifdef _WIN32
+    int depth = CaptureStackBackTrace(skippedFrames, maxFrames, stack, nullptr);
+    void** frames = stack;
+#else
+    int depth = backtrace(stack, static_cast<int>(maxFrames + skippedFrames)) - skippedFrames;
+    void** frames = stack + skippedFrames;
+#endif
+    depth = std::max(depth, 0);
+    const std::uint64_t hash = HashFrames(frames, depth);
+
+    for (std::size_t probe = 0; probe < maxCallsites; probe++)
+    {
+        const std::size_t index = (hash + probe) % maxCallsites;
+        Entry& entry = slot.entries[index];
+        if (entry.hash == 0)
+        {
+            entry.hash = hash;
+            entry.depth = static_cast<std::uint32_t>(depth);
+            std::copy(frames, frames + depth, entry.frames.begin());
+            const std::uint32_t count = slot.entryCount.load(std::memory_order_relaxed);
+            slot.usedEntries[count] = static_cast<std::uint16_t>(index);
+            slot.entryCount.store(count + 1, std::memory_order_release);
+        }
+        else if (entry.hash != hash)
+        {
+            continue;
+        }
+        Add(entry.count, rate);
+        Add(entry.bytes, static_cast<std::uint64_t>(size) * rate);
+        return;
+    }
+    Add(slot.droppedSamples, 1);
+}
+
+void AllocationTracker::RecordEvent(Slot& slot, AllocationEvent event, void* ptr, std::size_t size, std::size_t alignment,
+    std::chrono::steady_clock::time_point time)
+{
+    AllocationTraceRecord record;
+    //taken after the allocation and before the free: a block freed by a thread and given again to another one
+    //is ordered correctly by the timestamps
+    if (time == std::chrono::steady_clock::time_point{})
+    {
+        time = std::chrono::steady_clock::now();
+    }
+    record.timestamp = static_cast<std::uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(time - traceStart_).count());
+    record.address = reinterpret_cast<std::uintptr_t>(ptr);
+    record.size = static_cast<std::uint32_t>(std::min<std::size_t>(size, UINT32_MAX));
+    record.thread = static_cast<std::uint16_t>(&slot - slots_.data());
+    record.alignmentLog2 = AlignmentLog2(alignment);
+    record.event = event;
+
+    std::lock_guard<SpinLock> lock(slot.traceLock);
+    slot.traceRecords[slot.traceCount++] = record;
+    if (slot.traceCount == traceBufferSize)
+    {
+        FlushTrace(slot);
+    }
+}
+
+void AllocationTracker::FlushTrace(Slot& slot)
+{
+    std::lock_guard<std::mutex> lock(traceFileLock_);
+    if (traceFile_ != nullptr && slot.traceCount > 0)
+    {
+        std::fwrite(slot.traceRecords.data(), sizeof(AllocationTraceRecord), slot.traceCount, traceFile_);
+    }
+    slot.traceCount = 0;
+}
+
+bool AllocationTracker::StartRecording(const char* path)
+{
+    ReentryGuard guard;
+    std::lock_guard<std::mutex> lock(traceFileLock_);
+    if (traceFile_ != nullptr)
+    {
+        return false;
+    }
+    traceFile_ = std::fopen(path, "wb");
+    if (traceFile_ == nullptr)
+    {
+        return false;
+    }
+    const AllocationTraceHeader header;
+    std::fwrite(&header, sizeof(header), 1, traceFile_);
+    for (auto& slot : slots_)
+    {
+        //records left by a previous recording
+        std::lock_guard<SpinLock> slotLock(slot.traceLock);
+        slot.traceCount = 0;
+    }
+    traceStart_ = std::chrono::steady_clock::now();
+    recording_.store(true, std::memory_order_release);
+    return true;
+}
+
+void AllocationTracker::StopRecording()
+{
+    ReentryGuard guard;
+    recording_.store(false, std::memory_order_relaxed);
+    //a thread still in RecordEvent adds its record before or after the flush of its slot, the records
+    //added after are dropped by the next StartRecording
+    for (auto& slot : slots_)
+    {
+        std::lock_guard<SpinLock> lock(slot.traceLock);
+        FlushTrace(slot);
+    }
+    std::lock_guard<std::mutex> lock(traceFileLock_);
+    if (traceFile_ != nullptr)
+    {
+        std::fclose(traceFile_);
+        traceFile_ = nullptr;
+    }
+}
+
+AllocationTracker::Report AllocationTracker::EndFrame(std::size_t topCount)
+{
+    ReentryGuard guard;
+    Report report = Collect(topCount, &frameStates_);
+    const std::uint64_t untracked = untrackedAllocations_.load(std::memory_order_relaxed);
+    report.untrackedAllocations = untracked - previousUntrackedAllocations_;
+    previousUntrackedAllocations_ = untracked;
+    return report;
+}
+
+AllocationTracker::Report AllocationTracker::GetTotalReport(std::size_t topCount) const
+{
+    ReentryGuard guard;
+    Report report = Collect(topCount, nullptr);
+    report.untrackedAllocations = untrackedAllocations_.load(std::memory_order_relaxed);
+    return report;
+}
+
+AllocationTracker::Report AllocationTracker::Collect(std::size_t topCount, std::array<FrameState, maxThreads>* previous) const
+{
+    Report report;
+    for (std::size_t slotIndex = 0; slotIndex < maxThreads; slotIndex++)
+    {
+        const Slot& slot = slots_[slotIndex];
+        const std::uint32_t entryCount = slot.entryCount.load(std::memory_order_acquire);
+        std::uint64_t allocations = slot.allocations.load(std::memory_order_relaxed);
+        std::uint64_t bytes = slot.bytes.load(std::memory_order_relaxed);
+        std::uint64_t deallocations = slot.deallocations.load(std::memory_order_relaxed);
+        std::uint64_t droppedSamples = slot.droppedSamples.load(std::memory_order_relaxed);
+        FrameState* frame = previous != nullptr ? &(*previous)[slotIndex] : nullptr;
+        if (frame != nullptr)
+        {
+            allocations -= std::exchange(frame->allocations, allocations);
+            bytes -= std::exchange(frame->bytes, bytes);
+            deallocations -= std::exchange(frame->deallocations, deallocations);
+            droppedSamples -= std::exchange(frame->droppedSamples, droppedSamples);
+        }
+        report.allocations += allocations;
+        report.bytes += bytes;
+        report.deallocations += deallocations;
+        report.droppedSamples += droppedSamples;
+
+        for (std::uint32_t i = 0; i < entryCount; i++)
+        {
+            const std::uint16_t index = slot.usedEntries[i];
+            const Entry& entry = slot.entries[index];
+            std::uint64_t count = entry.count.load(std::memory_order_relaxed);
+            std::uint64_t entryBytes = entry.bytes.load(std::memory_order_relaxed);
+            if (frame != nullptr)
+            {
+                count -= std::exchange(frame->counts[index], count);
+                entryBytes -= std::exchange(frame->entryBytes[index], entryBytes);
+            }
+            if (count == 0)
+            {
+                continue;
+            }
+            Callsite& callsite = report.callsites.emplace_back();
+            callsite.hash = entry.hash;
+            callsite.depth = entry.depth;
+            callsite.frames = entry.frames;
+            callsite.count = count;
+            callsite.bytes = entryBytes;
+        }
+    }
+
+    //merge the callsites seen by several threads
+    auto& callsites = report.callsites;
+    std::sort(callsites.begin(), callsites.end(), [](const Callsite& a, const Callsite& b) { return a.hash < b.hash; });
+    std::size_t merged = 0;
+    for (std::size_t i = 0; i < callsites.size(); i++)
+    {
+        if (merged > 0 && callsites[merged - 1].hash == callsites[i].hash)
+        {
+            callsites[merged - 1].count += callsites[i].count;
+            callsites[merged - 1].bytes += callsites[i].bytes;
+        }
+        else
+        {
+            callsites[merged++] = callsites[i];
+        }
+    }
+    callsites.resize(merged);
+
+    const std::size_t top = std::min(topCount, callsites.size());
+    std::partial_sort(callsites.begin(), callsites.begin() + top, callsites.end(),
+        [](const Callsite& a, const Callsite& b) { return a.bytes > b.bytes; });
+    callsites.resize(top);
+    return report;
+}
+
+std::string AllocationTracker::Symbolize(void* address)
+{
+    ReentryGuard guard;
+    char buffer[32];
+    std::snprintf(buffer, sizeof(buffer), "%p", address);
+#ifdef _WIN32
+    static const bool initialized = SymInitialize(GetCurrentProcess(), nullptr, TRUE);
+    alignas(SYMBOL_INFO) char symbolBuffer[sizeof(SYMBOL_INFO) + MAX_SYM_NAME];
+    auto* symbol = reinterpret_cast<SYMBOL_INFO*>(symbolBuffer);
+    symbol->SizeOfStruct = sizeof(SYMBOL_INFO);
+    symbol->MaxNameLen = MAX_SYM_NAME;
+    DWORD64 displacement = 0;
+    if (initialized && SymFromAddr(GetCurrentProcess(), reinterpret_cast<DWORD64>(address), &displacement, symbol))
+    {
+        return std::string(symbol->Name) + " (" + buffer + ")";
+    }
+    return buffer;
+#else
+    //needs the symbols exported to the dynamic table, the AllocationTracker target links with -rdynamic
+    Dl_info info{};
+    if (dladdr(address, &info) == 0 || info.dli_sname == nullptr)
+    {
+        return info.dli_fname != nullptr ? std::string(info.dli_fname) + " (" + buffer + ")" : buffer;
+    }
+    int status = 0;
+    char* demangled = abi::__cxa_demangle(info.dli_sname, nullptr, nullptr, &status);
+    std::string name = status == 0 ? demangled : info.dli_sname;
+    std::free(demangled);
+    return name + " (" + buffer + ")";
+#endif
+}
+
+void AllocationTracker::PrintReport(const Report& report, std::FILE* file)
+{
+    ReentryGuard guard;
+    std::fprintf(file, "%" PRIu64 " allocations, %" PRIu64 " bytes, %" PRIu64 " deallocations",
+        report.allocations, report.bytes, report.deallocations);
+    if (report.droppedSamples > 0 || report.untrackedAllocations > 0)
+    {
+        std::fprintf(file, " (%" PRIu64 " samples dropped, %" PRIu64 " untracked allocations)",
+            report.droppedSamples, report.untrackedAllocations);
+    }
+    std::fprintf(file, "\n");
+    for (const auto& callsite : report.callsites)
+    {
+        std::fprintf(file, "%" PRIu64 " allocations, %" PRIu64 " bytes\n", callsite.count, callsite.bytes);
+        for (std::uint32_t i = 0; i < callsite.depth; i++)
+        {
+            std::fprintf(file, "    %s\n", Symbolize(callsite.frames[i]).c_str());
+        }
+    }
+}
+
+//Replaced allocation functions, forwarded to the system allocator
+
+namespace
+{
+    void* RawAllocate(std::size_t size)
+    {
+#ifdef __GLIBC__
+        return __libc_malloc(size);
+#else
+        return std::malloc(size);
+#endif
+    }
+
+    void* RawAlignedAllocate(std::size_t size, std::size_t alignment)
+    {
+#ifdef _WIN32
+        return _aligned_malloc(size, alignment);
+#elif defined(__GLIBC__)
+        return __libc_memalign(alignment, size);
+#else
+        return std::aligned_alloc(alignment, (size + alignment - 1) & ~(alignment - 1));
+#endif
+    }
+
+    void RawFree(void* ptr)
+    {
+#ifdef __GLIBC__
+        __libc_free(ptr);
+#else
+        std::free(ptr);
+#endif
+    }
+
+    void RawAlignedFree(void* ptr)
+    {
+#ifdef _WIN32
+        _aligned_free(ptr);
+#else
+        RawFree(ptr);
+#endif
+    }
+
+    FORCEINLINE void* TrackedNew(std::size_t size, std::size_t alignment, bool noThrow)
+    {
+        size = std::max<std::size_t>(size, 1);
+        while (true)
+        {
+            void* ptr = alignment > __STDCPP_DEFAULT_NEW_ALIGNMENT__ ? RawAlignedAllocate(size, alignment) : RawAllocate(size);
+            if (ptr != nullptr) [[likely]]
+            {
+                AllocationTracker::Get().OnAllocation(ptr, size, std::max<std::size_t>(alignment, __STDCPP_DEFAULT_NEW_ALIGNMENT__));
+                return ptr;
+            }
+            std::new_handler handler = std::get_new_handler();
+            if (handler == nullptr)
+            {
+                if (noThrow)
+                    return nullptr;
+#if __cpp_exceptions
+                throw std::bad_alloc();
+#else
+                std::abort();
+#endif
+            }
+            handler();
+        }
+    }
+
+    void TrackedDelete(void* ptr, std::size_t alignment)
+    {
+        if (ptr == nullptr)
+            return;
+        AllocationTracker::Get().OnDeallocation(ptr);
+        if (alignment > __STDCPP_DEFAULT_NEW_ALIGNMENT__)
+            RawAlignedFree(ptr);
+        else
+            RawFree(ptr);
+    }
+}
+
+void* operator new(std::size_t size) { return TrackedNew(size, 0, false); }
+void* operator new[](std::size_t size) { return TrackedNew(size, 0, false); }
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept { return TrackedNew(size, 0, true); }
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept { return TrackedNew(size, 0, true); }
+void* operator new(std::size_t size, std::align_val_t alignment) { return TrackedNew(size, static_cast<std::size_t>(alignment), false); }
+void* operator new[](std::size_t size, std::align_val_t alignment) { return TrackedNew(size, static_cast<std::size_t>(alignment), false); }
+void* operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept { return TrackedNew(size, static_cast<std::size_t>(alignment), true); }
+void* operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept { return TrackedNew(size, static_cast<std::size_t>(alignment), true); }
+
+void operator delete(void* ptr) noexcept { TrackedDelete(ptr, 0); }
+void operator delete[](void* ptr) noexcept { TrackedDelete(ptr, 0); }
+void operator delete(void* ptr, std::size_t) noexcept { TrackedDelete(ptr, 0); }
+void operator delete[](void* ptr, std::size_t) noexcept { TrackedDelete(ptr, 0); }
+void operator delete(void* ptr, const std::nothrow_t&) noexcept { TrackedDelete(ptr, 0); }
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept { TrackedDelete(ptr, 0); }
+void operator delete(void* ptr, std::align_val_t alignment) noexcept { TrackedDelete(ptr, static_cast<std::size_t>(alignment)); }
+void operator delete[](void* ptr, std::align_val_t alignment) noexcept { TrackedDelete(ptr, static_cast<std::size_t>(alignment)); }
+void operator delete(void* ptr, std::size_t, std::align_val_t alignment) noexcept { TrackedDelete(ptr, static_cast<std::size_t>(alignment)); }
+void operator delete[](void* ptr, std::size_t, std::align_val_t alignment) noexcept { TrackedDelete(ptr, static_cast<std::size_t>(alignment)); }
+void operator delete(void* ptr, std::align_val_t alignment, const std::nothrow_t&) noexcept { TrackedDelete(ptr, static_cast<std::size_t>(alignment)); }
+void operator delete[](void* ptr, std::align_val_t alignment, const std::nothrow_t&) noexcept { TrackedDelete(ptr, static_cast<std::size_t>(alignment)); }
+
+#ifdef __GLIBC__
+//the malloc family can only be replaced with glibc, other platforms track operator new/delete only
+extern "C"
+{
+    void* malloc(std::size_t size) noexcept
+    {
+        void* ptr = __libc_malloc(size);
+        if (ptr != nullptr)
+            AllocationTracker::Get().OnAllocation(ptr, size, alignof(std::max_align_t));
+        return ptr;
+    }
+
+    void* calloc(std::size_t count, std::size_t size) noexcept
+    {
+        void* ptr = __libc_calloc(count, size);
+        if (ptr != nullptr)
+            AllocationTracker::Get().OnAllocation(ptr, count * size, alignof(std::max_align_t));
+        return ptr;
+    }
+
+    void* realloc(void* ptr, std::size_t size) noexcept
+    {
+        //the free is only known once the call succeeded (a failed realloc keeps the block), it is timed before the
+        //call: another thread can get the block back before the free is recorded
+        const auto time = ptr != nullptr && AllocationTracker::Get().IsRecording() ?
+            std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point{};
+        void* newPtr = __libc_realloc(ptr, size);
+        if (ptr != nullptr && (newPtr != nullptr || size == 0))
+            AllocationTracker::Get().OnDeallocation(ptr, time);
+        if (newPtr != nullptr)
+            AllocationTracker::Get().OnAllocation(newPtr, size, alignof(std::max_align_t));
+        return newPtr;
+    }
+
+    void* memalign(std::size_t alignment, std::size_t size) noexcept
+    {
+        void* ptr = __libc_memalign(alignment, size);
+        if (ptr != nullptr)
+            AllocationTracker::Get().OnAllocation(ptr, size, alignment);
+        return ptr;
+    }
+
+    void* aligned_alloc(std::size_t alignment, std::size_t size) noexcept
+    {
+        void* ptr = __libc_memalign(alignment, size);
+        if (ptr != nullptr)
+            AllocationTracker::Get().OnAllocation(ptr, size, alignment);
+        return ptr;
+    }
+
+    int posix_memalign(void** result, std::size_t alignment, std::size_t size) noexcept
+    {
+        if (alignment % sizeof(void*) != 0 || (alignment & (alignment - 1)) != 0)
+            return EINVAL;
+        void* ptr = __libc_memalign(alignment, size);
+        if (ptr == nullptr)
+            return ENOMEM;
+        AllocationTracker::Get().OnAllocation(ptr, size, alignment);
+        *result = ptr;
+        return 0;
+    }
+
+    void free(void* ptr) noexcept
+    {
+        if (ptr != nullptr)
+            AllocationTracker::Get().OnDeallocation(ptr);
+        __libc_free(ptr);
+    }
+}
+#endif
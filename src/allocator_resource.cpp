@@ -0,0 +1,69 @@
+#include "allocator_resource.h"
+
+AllocatorResource::AllocatorResource(Allocator& allocator, std::pmr::memory_resource* upstream) :
+    allocator_(allocator),
+    upstream_(upstream)
+{
+}
+
+void* AllocatorResource::do_allocate(std::size_t bytes, std::size_t alignment)
+{
+    if (void* ptr = allocator_.Allocate(bytes, alignment)) [[likely]]
+        return ptr;
+    upstreamAllocations_++;
+    return upstream_->allocate(bytes, alignment);
+}
+
+void AllocatorResource::do_deallocate(void* ptr, std::size_t bytes, std::size_t alignment)
+{
+    if (allocator_.Owns(ptr)) [[likely]]
+    {
+        allocator_.Deallocate(ptr);
+        return;
+    }
+    upstream_->deallocate(ptr, bytes, alignment);
+}
+
+bool AllocatorResource::do_is_equal(const std::pmr::memory_resource& other) const noexcept
+{
+    return this == &other;
+}
+
+FrameResource::FrameResource(std::size_t size, std::pmr::memory_resource* upstream) :
+    upstream_(upstream),
+    buffer_(upstream->allocate(size, bufferAlignment)),
+    size_(size),
+    allocator_(buffer_, size)
+{
+}
+
+FrameResource::~FrameResource()
+{
+    upstream_->deallocate(buffer_, size_, bufferAlignment);
+}
+
+void FrameResource::Reset()
+{
+    allocator_.Clear();
+}
+
+void* FrameResource::do_allocate(std::size_t bytes, std::size_t alignment)
+{
+    if (void* ptr = allocator_.Allocate(bytes, alignment)) [[likely]]
+        return ptr;
+    //the frame is over budget
+    return upstream_->allocate(bytes, alignment);
+}
+
+void FrameResource::do_deallocate(void* ptr, std::size_t bytes, std::size_t alignment)
+{
+    if (!allocator_.Owns(ptr)) [[unlikely]]
+    {
+        upstream_->deallocate(ptr, bytes, alignment);
+    }
+}
+
+bool FrameResource::do_is_equal(const std::pmr::memory_resource& other) const noexcept
+{
+    return this == &other;
+}
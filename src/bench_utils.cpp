@@ -4,8 +4,18 @@
 
 #include "bench_utils.h"
 
+#include <algorithm>
+#include <cstdio>
 #include <random>
 
+#ifdef _WIN32
+#define NOMINMAX
+#include <Windows.h>
+#include <psapi.h>
+#else
+#include <unistd.h>
+#endif
+
 void FillRandom(maths::Vec3f& v)
 {
     static std::random_device rd;  //Will be used to obtain a seed for the random number engine
@@ -16,7 +26,7 @@ void FillRandom(maths::Vec3f& v)
     v[2] = dis(gen);
 }
 
-void FillRandom(std::vector<int> &v, int low, int high)
+void FillRandom(std::span<int> v, int low, int high)
 {
     static std::random_device rd;  //Will be used to obtain a seed for the random number engine
     static std::mt19937 gen(rd()); //Standard mersenne_twister_engine seeded with rd()
@@ -37,3 +47,23 @@ void FillRandom(maths::Mat4f &m)
         }
     }
 }
+
+std::size_t GetResidentMemory()
+{
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters{};
+    if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+        return 0;
+    return counters.WorkingSetSize;
+#else
+    //second field of statm: resident pages
+    std::FILE* file = std::fopen("/proc/self/statm", "r");
+    if (file == nullptr)
+        return 0;
+    unsigned long long size = 0;
+    unsigned long long resident = 0;
+    const int read = std::fscanf(file, "%llu %llu", &size, &resident);
+    std::fclose(file);
+    return read == 2 ? static_cast<std::size_t>(resident) * static_cast<std::size_t>(sysconf(_SC_PAGESIZE)) : 0;
+#endif
+}
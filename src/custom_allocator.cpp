@@ -1,7 +1,54 @@
 #include "custom_allocator.h"
 #include "custom_allocator.h"
 #include <algorithm>
+#include <bit>
 #include <iostream>
+#include <mutex>
+
+#include "sharded_counter.h"
+
+#ifdef TRACY_ENABLE
+#include <tracy/Tracy.hpp>
+#endif
+
+std::size_t Allocator::GetSizeHistogramBucket(std::size_t allocationSize)
+{
+    if (allocationSize <= 1)
+        return 0;
+    return std::min<std::size_t>(std::bit_width(allocationSize - 1), sizeHistogramBucketCount - 1);
+}
+
+void Allocator::RecordAllocation([[maybe_unused]] void* ptr, std::size_t allocationSize)
+{
+    peakMemory_ = std::max(peakMemory_, usedMemory_);
+    sizeHistogram_[GetSizeHistogramBucket(allocationSize)]++;
+#ifdef TRACY_ENABLE
+    TracyAllocN(ptr, allocationSize, name_);
+#endif
+}
+
+void Allocator::RecordDeallocation([[maybe_unused]] void* ptr)
+{
+#ifdef TRACY_ENABLE
+    TracyFreeN(ptr, name_);
+#endif
+}
+
+void Allocator::RecordArenaAllocation(std::size_t allocationSize)
+{
+    peakMemory_ = std::max(peakMemory_, usedMemory_);
+    sizeHistogram_[GetSizeHistogramBucket(allocationSize)]++;
+#ifdef TRACY_ENABLE
+    TracyPlot(name_, static_cast<int64_t>(usedMemory_));
+#endif
+}
+
+void Allocator::RecordArenaReset()
+{
+#ifdef TRACY_ENABLE
+    TracyPlot(name_, static_cast<int64_t>(usedMemory_));
+#endif
+}
 
 LinearAllocator::LinearAllocator(void* rootPtr, std::size_t totalSize) :
     Allocator(rootPtr, totalSize),
@@ -13,12 +60,16 @@ void* LinearAllocator::Allocate(std::size_t allocationSize, std::size_t alignmen
 {
     const auto adjustment = alignForwardAdjustment(currentPtr_, alignment);
     if (usedMemory_ + adjustment + allocationSize > totalSize_) [[unlikely]]
+    {
+        RecordFailure();
         return nullptr;
+    }
 
     const auto alignedAddress = reinterpret_cast<std::uintptr_t>(currentPtr_) + adjustment;
     currentPtr_ = reinterpret_cast<void*>(alignedAddress + allocationSize);
     usedMemory_ += allocationSize + adjustment;
     numAllocations_++;
+    RecordArenaAllocation(allocationSize);
     return reinterpret_cast<void*>(alignedAddress);
 }
 
@@ -32,6 +83,45 @@ void LinearAllocator::Clear()
     currentPtr_ = rootPtr_;
     numAllocations_ = 0;
     usedMemory_ = 0;
+    RecordArenaReset();
+}
+
+DoubleFrameAllocator::DoubleFrameAllocator(void* rootPtr, std::size_t totalSize) :
+    Allocator(rootPtr, totalSize),
+    frames_{LinearAllocator(rootPtr, totalSize / 2),
+            LinearAllocator(static_cast<char*>(rootPtr) + totalSize / 2, totalSize / 2)}
+{
+    frames_[0].SetName("Frame allocator 0");
+    frames_[1].SetName("Frame allocator 1");
+}
+
+void* DoubleFrameAllocator::Allocate(std::size_t allocationSize, std::size_t alignment)
+{
+    LinearAllocator& frame = frames_[current_];
+    void* ptr = frame.Allocate(allocationSize, alignment);
+    if (ptr == nullptr) [[unlikely]]
+    {
+        RecordFailure();
+        return nullptr;
+    }
+    usedMemory_ = frames_[0].GetUsedMemory() + frames_[1].GetUsedMemory();
+    numAllocations_ = frames_[0].GetNumAllocations() + frames_[1].GetNumAllocations();
+    RecordArenaAllocation(allocationSize);
+    return ptr;
+}
+
+void DoubleFrameAllocator::Deallocate(void* ptr)
+{
+}
+
+void DoubleFrameAllocator::SwapFrames()
+{
+    peakFrameUsedMemory_ = std::max(peakFrameUsedMemory_, GetFrameUsedMemory());
+    current_ ^= 1;
+    frames_[current_].Clear();
+    usedMemory_ = frames_[current_ ^ 1].GetUsedMemory();
+    numAllocations_ = frames_[current_ ^ 1].GetNumAllocations();
+    RecordArenaReset();
 }
 
 StackAllocator::StackAllocator(void* rootPtr, std::size_t totalSize) :
@@ -44,7 +134,10 @@ void* StackAllocator::Allocate(std::size_t allocationSize, std::size_t alignment
 {
     const auto adjustment = alignForwardAdjustmentWithHeader(currentPos_, alignment);
     if (usedMemory_ + adjustment + allocationSize > totalSize_) [[unlikely]]
+    {
+        RecordFailure();
         return nullptr;
+    }
     const std::uintptr_t alignedAddress = reinterpret_cast<std::uintptr_t>(currentPos_) + adjustment;
     auto* header = reinterpret_cast<AllocationHeader*>(alignedAddress - sizeof(AllocationHeader));
     header->adjustment = adjustment;
@@ -52,6 +145,7 @@ void* StackAllocator::Allocate(std::size_t allocationSize, std::size_t alignment
     currentPos_ = reinterpret_cast<void*>(alignedAddress + allocationSize);
     usedMemory_ += allocationSize + adjustment;
     numAllocations_++;
+    RecordArenaAllocation(allocationSize);
     return reinterpret_cast<void*>(alignedAddress);
 }
 
@@ -60,6 +154,111 @@ void StackAllocator::Deallocate(void* ptr)
     const auto* header = reinterpret_cast<AllocationHeader*>(reinterpret_cast<std::uintptr_t>(ptr) - sizeof(AllocationHeader));
     usedMemory_ -= reinterpret_cast<std::uintptr_t>(currentPos_) - reinterpret_cast<std::uintptr_t>(ptr) + header->adjustment;
     currentPos_ = reinterpret_cast<void*>(reinterpret_cast<std::uintptr_t>(ptr)- header->adjustment);
+    numAllocations_--;
+    RecordArenaReset();
+}
+
+void StackAllocator::FreeToMarker(StackMarker marker)
+{
+    currentPos_ = static_cast<char*>(rootPtr_) + marker.offset;
+    usedMemory_ = marker.offset;
+    numAllocations_ = marker.numAllocations;
+    RecordArenaReset();
+}
+
+DoubleEndedStackAllocator::DoubleEndedStackAllocator(void* rootPtr, std::size_t totalSize) :
+    Allocator(rootPtr, totalSize)
+{
+}
+
+void* DoubleEndedStackAllocator::Allocate(std::size_t allocationSize, std::size_t alignment)
+{
+    return AllocateBottom(allocationSize, alignment);
+}
+
+void* DoubleEndedStackAllocator::AllocateBottom(std::size_t allocationSize, std::size_t alignment)
+{
+    const auto root = reinterpret_cast<std::uintptr_t>(rootPtr_);
+    const auto alignedAddress = reinterpret_cast<std::uintptr_t>(
+        alignForward(reinterpret_cast<void*>(root + bottom_ + sizeof(AllocationHeader)), std::max(alignment, alignof(AllocationHeader))));
+    const std::size_t newBottom = alignedAddress + allocationSize - root;
+    if (newBottom + top_ > totalSize_) [[unlikely]]
+    {
+        RecordFailure();
+        return nullptr;
+    }
+    reinterpret_cast<AllocationHeader*>(alignedAddress - sizeof(AllocationHeader))->previousOffset = bottom_;
+    bottom_ = newBottom;
+    bottomAllocations_++;
+    Update();
+    RecordArenaAllocation(allocationSize);
+    return reinterpret_cast<void*>(alignedAddress);
+}
+
+void* DoubleEndedStackAllocator::AllocateTop(std::size_t allocationSize, std::size_t alignment)
+{
+    //the top grows down, align the address down
+    alignment = std::max(alignment, alignof(AllocationHeader));
+    const auto root = reinterpret_cast<std::uintptr_t>(rootPtr_);
+    const std::uintptr_t topAddress = root + totalSize_ - top_;
+    if (allocationSize + sizeof(AllocationHeader) > topAddress - root - bottom_) [[unlikely]]
+    {
+        RecordFailure();
+        return nullptr;
+    }
+    const std::uintptr_t alignedAddress = (topAddress - allocationSize) & ~(alignment - 1);
+    if (alignedAddress < root + bottom_ + sizeof(AllocationHeader)) [[unlikely]]
+    {
+        RecordFailure();
+        return nullptr;
+    }
+    reinterpret_cast<AllocationHeader*>(alignedAddress - sizeof(AllocationHeader))->previousOffset = top_;
+    top_ = root + totalSize_ - (alignedAddress - sizeof(AllocationHeader));
+    topAllocations_++;
+    Update();
+    RecordArenaAllocation(allocationSize);
+    return reinterpret_cast<void*>(alignedAddress);
+}
+
+void DoubleEndedStackAllocator::Deallocate(void* ptr)
+{
+    const auto address = reinterpret_cast<std::uintptr_t>(ptr);
+    const auto* header = reinterpret_cast<const AllocationHeader*>(address - sizeof(AllocationHeader));
+    //a top block always starts after its header above the top boundary, a zero size bottom block can end on the bottom one
+    if (address > reinterpret_cast<std::uintptr_t>(rootPtr_) + totalSize_ - top_)
+    {
+        top_ = header->previousOffset;
+        topAllocations_--;
+    }
+    else
+    {
+        bottom_ = header->previousOffset;
+        bottomAllocations_--;
+    }
+    Update();
+    RecordArenaReset();
+}
+
+void DoubleEndedStackAllocator::FreeToBottomMarker(StackMarker marker)
+{
+    bottom_ = marker.offset;
+    bottomAllocations_ = marker.numAllocations;
+    Update();
+    RecordArenaReset();
+}
+
+void DoubleEndedStackAllocator::FreeToTopMarker(StackMarker marker)
+{
+    top_ = marker.offset;
+    topAllocations_ = marker.numAllocations;
+    Update();
+    RecordArenaReset();
+}
+
+void DoubleEndedStackAllocator::Update()
+{
+    usedMemory_ = bottom_ + top_;
+    numAllocations_ = bottomAllocations_ + topAllocations_;
 }
 
 std::uintptr_t StackAllocator::alignForwardAdjustmentWithHeader(const void* address, std::uintptr_t alignment)
@@ -74,127 +273,715 @@ std::uintptr_t StackAllocator::alignForwardAdjustmentWithHeader(const void* addr
 
 FreeListAllocator::FreeListAllocator(void* rootPtr, std::size_t totalSize) : Allocator(rootPtr, totalSize)
 {
-    const auto adjustment = alignForwardAdjustment(rootPtr, alignof(AllocationHeader));
-    freeBlocks_ = reinterpret_cast<FreeBlock*>(reinterpret_cast<std::uintptr_t>(rootPtr)+adjustment);
-    freeBlocks_->freeSize = totalSize - adjustment;
-    freeBlocks_->next = nullptr;
-
+    const auto adjustment = alignForwardAdjustment(rootPtr, blockAlignment);
+    heapStart_ = reinterpret_cast<std::uintptr_t>(rootPtr) + adjustment;
+    const std::size_t heapSize = totalSize > adjustment ? (totalSize - adjustment) & ~(blockAlignment - 1) : 0;
+    heapEnd_ = heapStart_ + heapSize;
+    if (heapSize >= minBlockSize)
+    {
+        InsertFreeBlock(heapStart_, heapSize);
+    }
 }
 
 void* FreeListAllocator::Allocate(std::size_t allocationSize, std::size_t alignment)
 {
-    FreeBlock* prevFreeBlock = nullptr;
-    FreeBlock* freeBlock = freeBlocks_;
-
-    while (freeBlock != nullptr)
+    alignment = std::max(alignment, alignof(AllocationHeader));
+    for (FreeBlock* freeBlock = freeBlocks_; freeBlock != nullptr; freeBlock = freeBlock->next)
     {
-        //Calculate adjustment needed to keep object correctly aligned 
-        const auto adjustment = AlignForwardAdjustmentWithHeader(freeBlock, alignment);
-        size_t total_size = allocationSize + adjustment;
+        const auto block = reinterpret_cast<std::uintptr_t>(freeBlock);
+        const std::size_t freeSize = GetSize(block);
 
-        //If allocation doesn't fit in this FreeBlock, try the next 
-        if (freeBlock->freeSize < total_size)
-        {
-            prevFreeBlock = freeBlock;
-            freeBlock = freeBlock->next;
+        //the allocation header sits right before the aligned address, after the block tag
+        const auto payloadStart = block + sizeof(BoundaryTag) + sizeof(AllocationHeader);
+        const auto alignedAddress = reinterpret_cast<std::uintptr_t>(alignForward(reinterpret_cast<void*>(payloadStart), alignment));
+        std::size_t neededSize = alignedAddress + allocationSize + sizeof(BoundaryTag) - block;
+        neededSize = std::max((neededSize + blockAlignment - 1) & ~(blockAlignment - 1), minBlockSize);
+
+        //If allocation doesn't fit in this FreeBlock, try the next
+        if (freeSize < neededSize)
             continue;
+
+        RemoveFreeBlock(freeBlock);
+        std::size_t blockSize = freeSize;
+        //Give the remaining memory back as a new free block if it can hold one
+        if (freeSize - neededSize >= minBlockSize)
+        {
+            blockSize = neededSize;
+            InsertFreeBlock(block + neededSize, freeSize - neededSize);
         }
+        SetTags(block, blockSize, true);
+
+        auto* header = reinterpret_cast<AllocationHeader*>(alignedAddress - sizeof(AllocationHeader));
+        header->blockOffset = alignedAddress - block;
+        usedMemory_ += blockSize;
+        numAllocations_++;
+        RecordAllocation(reinterpret_cast<void*>(alignedAddress), allocationSize);
+
+        return reinterpret_cast<void*>(alignedAddress);
+    }
+
+    //ASSERT(false && "Couldn't find free block large enough!");
+    RecordFailure();
+    return nullptr;
+}
 
-        static_assert(sizeof(AllocationHeader) >= sizeof(FreeBlock), "sizeof(AllocationHeader) < sizeof(FreeBlock)");
+void FreeListAllocator::Deallocate(void* ptr)
+{
+    const auto address = reinterpret_cast<std::uintptr_t>(ptr);
+    const auto* header = reinterpret_cast<const AllocationHeader*>(address - sizeof(AllocationHeader));
+    std::uintptr_t block = address - header->blockOffset;
+    std::size_t blockSize = GetSize(block);
+
+    numAllocations_--;
+    usedMemory_ -= blockSize;
+    RecordDeallocation(ptr);
 
-        //If allocations in the remaining memory will be impossible 
-        if (freeBlock->freeSize - total_size <= sizeof(AllocationHeader))
+    //merge with the next block in memory, its header follows our footer
+    const std::uintptr_t next = block + blockSize;
+    if (next < heapEnd_ && !IsAllocated(next))
+    {
+        RemoveFreeBlock(reinterpret_cast<FreeBlock*>(next));
+        blockSize += GetSize(next);
+    }
+    //merge with the previous block in memory, its footer precedes our header
+    if (block > heapStart_)
+    {
+        const std::uintptr_t previousFooter = block - sizeof(BoundaryTag);
+        if (!IsAllocated(previousFooter))
         {
-            //Increase allocation size instead of creating a new FreeBlock 
-            total_size = freeBlock->freeSize;
+            const std::size_t previousSize = GetSize(previousFooter);
+            block -= previousSize;
+            RemoveFreeBlock(reinterpret_cast<FreeBlock*>(block));
+            blockSize += previousSize;
+        }
+    }
+    InsertFreeBlock(block, blockSize);
+}
+
+std::size_t FreeListAllocator::GetFreeBlockCount() const
+{
+    std::size_t count = 0;
+    for (const FreeBlock* freeBlock = freeBlocks_; freeBlock != nullptr; freeBlock = freeBlock->next)
+    {
+        count++;
+    }
+    return count;
+}
+
+std::size_t FreeListAllocator::GetLargestFreeBlock() const
+{
+    std::size_t largest = 0;
+    for (const FreeBlock* freeBlock = freeBlocks_; freeBlock != nullptr; freeBlock = freeBlock->next)
+    {
+        largest = std::max(largest, GetSize(reinterpret_cast<std::uintptr_t>(freeBlock)));
+    }
+    return largest;
+}
+
+float FreeListAllocator::GetFragmentation() const
+{
+    const std::size_t freeMemory = heapEnd_ - heapStart_ - usedMemory_;
+    if (freeMemory == 0)
+        return 0.0f;
+    return 1.0f - static_cast<float>(GetLargestFreeBlock()) / static_cast<float>(freeMemory);
+}
 
-            if (prevFreeBlock != nullptr)
-                prevFreeBlock->next = freeBlock->next;
-            else
-                freeBlocks_ = freeBlock->next;
+void FreeListAllocator::SetTags(std::uintptr_t block, std::size_t size, bool allocated)
+{
+    const std::size_t value = size | (allocated ? allocatedFlag : 0);
+    reinterpret_cast<BoundaryTag*>(block)->sizeAndFlag = value;
+    reinterpret_cast<BoundaryTag*>(block + size - sizeof(BoundaryTag))->sizeAndFlag = value;
+}
+
+void FreeListAllocator::InsertFreeBlock(std::uintptr_t block, std::size_t size)
+{
+    SetTags(block, size, false);
+    auto* freeBlock = reinterpret_cast<FreeBlock*>(block);
+    freeBlock->prev = nullptr;
+    freeBlock->next = freeBlocks_;
+    if (freeBlocks_ != nullptr)
+        freeBlocks_->prev = freeBlock;
+    freeBlocks_ = freeBlock;
+}
+
+void FreeListAllocator::RemoveFreeBlock(FreeBlock* block)
+{
+    if (block->prev != nullptr)
+        block->prev->next = block->next;
+    else
+        freeBlocks_ = block->next;
+    if (block->next != nullptr)
+        block->next->prev = block->prev;
+}
+
+TlsfAllocator::TlsfAllocator(void* rootPtr, std::size_t totalSize) : Allocator(rootPtr, totalSize)
+{
+    //payloads are aligned on blockAlignment, the headers just before them
+    const auto root = reinterpret_cast<std::uintptr_t>(rootPtr);
+    const auto end = root + totalSize;
+    auto first = reinterpret_cast<std::uintptr_t>(alignForward(reinterpret_cast<void*>(root + sizeof(std::size_t)), blockAlignment)) - sizeof(std::size_t);
+    //the last header is an empty allocated block, the last real block always has a next one
+    if (first + minBlockSize + sizeof(std::size_t) > end)
+        return;
+    const std::size_t size = (end - sizeof(std::size_t) - first) & ~(blockAlignment - 1);
+    auto* block = reinterpret_cast<BlockHeader*>(first);
+    block->sizeAndFlags = 0;
+    InsertFreeBlock(block, size);
+    GetNext(block)->sizeAndFlags = prevFreeFlag;
+}
+
+void TlsfAllocator::MapInsert(std::size_t size, std::size_t& firstLevel, std::size_t& secondLevel)
+{
+    if (size < smallBlockSize)
+    {
+        firstLevel = 0;
+        secondLevel = size / (smallBlockSize / secondLevelCount);
+        return;
+    }
+    const std::size_t log2 = std::bit_width(size) - 1;
+    secondLevel = (size >> (log2 - secondLevelLog2)) ^ secondLevelCount;
+    firstLevel = log2 - firstLevelShift + 1;
+}
+
+void TlsfAllocator::InsertFreeBlock(BlockHeader* block, std::size_t size)
+{
+    std::size_t firstLevel, secondLevel;
+    MapInsert(size, firstLevel, secondLevel);
+    block->sizeAndFlags = size | freeFlag | (block->sizeAndFlags & prevFreeFlag);
+    //boundary tag for the merge with the next block
+    *reinterpret_cast<std::size_t*>(reinterpret_cast<char*>(block) + size - sizeof(std::size_t)) = size;
+
+    BlockHeader*& head = freeBlocks_[firstLevel][secondLevel];
+    block->prevFree = nullptr;
+    block->nextFree = head;
+    if (head != nullptr)
+        head->prevFree = block;
+    head = block;
+    firstLevelBitmap_ |= std::uint64_t(1) << firstLevel;
+    secondLevelBitmaps_[firstLevel] |= std::uint32_t(1) << secondLevel;
+}
+
+void TlsfAllocator::RemoveFreeBlock(BlockHeader* block)
+{
+    std::size_t firstLevel, secondLevel;
+    MapInsert(GetSize(block), firstLevel, secondLevel);
+    if (block->prevFree != nullptr)
+        block->prevFree->nextFree = block->nextFree;
+    else
+        freeBlocks_[firstLevel][secondLevel] = block->nextFree;
+    if (block->nextFree != nullptr)
+        block->nextFree->prevFree = block->prevFree;
+
+    if (freeBlocks_[firstLevel][secondLevel] == nullptr)
+    {
+        secondLevelBitmaps_[firstLevel] &= ~(std::uint32_t(1) << secondLevel);
+        if (secondLevelBitmaps_[firstLevel] == 0)
+            firstLevelBitmap_ &= ~(std::uint64_t(1) << firstLevel);
+    }
+    block->sizeAndFlags &= ~freeFlag;
+}
+
+TlsfAllocator::BlockHeader* TlsfAllocator::TakeFreeBlock(std::size_t size)
+{
+    //round up to the next class, every block of that class is big enough
+    if (size >= smallBlockSize)
+    {
+        size += (std::size_t(1) << (std::bit_width(size) - 1 - secondLevelLog2)) - 1;
+    }
+    std::size_t firstLevel, secondLevel;
+    MapInsert(size, firstLevel, secondLevel);
+    if (firstLevel >= firstLevelCount) [[unlikely]]
+        return nullptr;
+
+    std::uint32_t secondLevelMap = secondLevelBitmaps_[firstLevel] & (~std::uint32_t(0) << secondLevel);
+    if (secondLevelMap == 0)
+    {
+        //nothing left in this first level, take the smallest bigger one
+        const std::uint64_t firstLevelMap = firstLevel + 1 < 64 ? firstLevelBitmap_ & (~std::uint64_t(0) << (firstLevel + 1)) : 0;
+        if (firstLevelMap == 0)
+            return nullptr;
+        firstLevel = std::countr_zero(firstLevelMap);
+        secondLevelMap = secondLevelBitmaps_[firstLevel];
+    }
+    secondLevel = std::countr_zero(secondLevelMap);
+    BlockHeader* block = freeBlocks_[firstLevel][secondLevel];
+    RemoveFreeBlock(block);
+    return block;
+}
+
+void TlsfAllocator::TrimBlock(BlockHeader* block, std::size_t size)
+{
+    const std::size_t blockSize = GetSize(block);
+    if (blockSize - size >= minBlockSize)
+    {
+        block->sizeAndFlags = size | (block->sizeAndFlags & prevFreeFlag);
+        auto* remainder = reinterpret_cast<BlockHeader*>(reinterpret_cast<char*>(block) + size);
+        //the previous block of the remainder is allocated
+        remainder->sizeAndFlags = 0;
+        InsertFreeBlock(remainder, blockSize - size);
+        GetNext(remainder)->sizeAndFlags |= prevFreeFlag;
+    }
+    else
+    {
+        GetNext(block)->sizeAndFlags &= ~prevFreeFlag;
+    }
+}
+
+void* TlsfAllocator::Allocate(std::size_t allocationSize, std::size_t alignment)
+{
+    std::size_t size = (allocationSize + sizeof(std::size_t) + blockAlignment - 1) & ~(blockAlignment - 1);
+    size = std::max(size, minBlockSize);
+    //over aligned: take enough to cut a free block in front of the aligned payload
+    const bool overAligned = alignment > blockAlignment;
+    BlockHeader* block = TakeFreeBlock(overAligned ? size + alignment + minBlockSize : size);
+    if (block == nullptr) [[unlikely]]
+    {
+        RecordFailure();
+        return nullptr;
+    }
+
+    if (overAligned)
+    {
+        const auto payload = reinterpret_cast<std::uintptr_t>(block) + sizeof(std::size_t);
+        std::size_t gap = reinterpret_cast<std::uintptr_t>(alignForward(reinterpret_cast<void*>(payload), alignment)) - payload;
+        if (gap != 0 && gap < minBlockSize)
+        {
+            gap += (minBlockSize - gap + alignment - 1) & ~(alignment - 1);
         }
-        else
+        if (gap != 0)
         {
-            //Else create a new FreeBlock containing remaining memory 
-            auto* next_block = reinterpret_cast<FreeBlock*>(reinterpret_cast<std::uintptr_t>(freeBlock) + total_size);
+            const std::size_t blockSize = GetSize(block);
+            InsertFreeBlock(block, gap);
+            block = reinterpret_cast<BlockHeader*>(reinterpret_cast<char*>(block) + gap);
+            block->sizeAndFlags = (blockSize - gap) | prevFreeFlag;
+        }
+    }
+    TrimBlock(block, size);
+
+    const std::size_t blockSize = GetSize(block);
+    usedMemory_ += blockSize;
+    numAllocations_++;
+    void* ptr = reinterpret_cast<char*>(block) + sizeof(std::size_t);
+    RecordAllocation(ptr, allocationSize);
+    return ptr;
+}
+
+void TlsfAllocator::Deallocate(void* ptr)
+{
+    auto* block = reinterpret_cast<BlockHeader*>(static_cast<char*>(ptr) - sizeof(std::size_t));
+    std::size_t size = GetSize(block);
+    usedMemory_ -= size;
+    numAllocations_--;
+    RecordDeallocation(ptr);
 
-            next_block->freeSize = freeBlock->freeSize - total_size;
-            next_block->next = freeBlock->next;
+    BlockHeader* next = GetNext(block);
+    if (next->sizeAndFlags & freeFlag)
+    {
+        RemoveFreeBlock(next);
+        size += GetSize(next);
+    }
+    if (block->sizeAndFlags & prevFreeFlag)
+    {
+        const std::size_t previousSize = *(reinterpret_cast<std::size_t*>(block) - 1);
+        block = reinterpret_cast<BlockHeader*>(reinterpret_cast<char*>(block) - previousSize);
+        RemoveFreeBlock(block);
+        size += previousSize;
+    }
+    InsertFreeBlock(block, size);
+    GetNext(block)->sizeAndFlags |= prevFreeFlag;
+}
 
-            if (prevFreeBlock != nullptr)
-                prevFreeBlock->next = next_block;
-            else
-                freeBlocks_ = next_block;
+std::size_t TlsfAllocator::GetFreeBlockCount() const
+{
+    std::size_t count = 0;
+    for (const auto& firstLevel : freeBlocks_)
+    {
+        for (const BlockHeader* block : firstLevel)
+        {
+            for (; block != nullptr; block = block->nextFree)
+            {
+                count++;
+            }
         }
+    }
+    return count;
+}
 
-        const auto aligned_address = reinterpret_cast<std::uintptr_t>(freeBlock) + adjustment;
-        auto* header = reinterpret_cast<AllocationHeader*>(aligned_address - sizeof(AllocationHeader));
-        header->allocationSize = total_size;
-        header->adjustment = adjustment;
-        usedMemory_ += total_size;
-        numAllocations_++;
+BuddyAllocator::BuddyAllocator(void* rootPtr, std::size_t totalSize, std::size_t minBlockSize) :
+    Allocator(rootPtr, totalSize),
+    minBlockSize_(std::bit_ceil(std::max(minBlockSize, sizeof(FreeBlock))))
+{
+    //the bitmaps cover the implicit tree over the blocks, rounded up to a power of two leaves
+    auto bitmapWords = [](std::size_t blocks)
+    {
+        const std::size_t nodes = 2 * std::bit_ceil(std::max<std::size_t>(blocks, 1));
+        return (nodes + 63) / 64;
+    };
+    //the heap starts the buffer to keep its alignment, the bitmaps take the end
+    const auto root = reinterpret_cast<std::uintptr_t>(rootPtr);
+    const auto end = root + totalSize;
+    heapStart_ = reinterpret_cast<std::uintptr_t>(alignForward(rootPtr, minBlockSize_));
+    if (heapStart_ >= end)
+        return;
+    //bitmaps sized for the whole buffer, a bit too big once they took their part of it
+    const std::size_t words = bitmapWords((end - heapStart_) / minBlockSize_);
+    if (2 * words * sizeof(std::uint64_t) >= end - heapStart_)
+        return;
+    const std::uintptr_t bitmapStart = (end - 2 * words * sizeof(std::uint64_t)) & ~(alignof(std::uint64_t) - 1);
+    heapBlocks_ = (bitmapStart - heapStart_) / minBlockSize_;
+    if (heapBlocks_ == 0)
+        return;
+    maxOrder_ = std::min<std::size_t>(std::bit_width(std::bit_ceil(heapBlocks_)) - 1, maxOrders - 1);
+    heapBlocks_ = std::min(heapBlocks_, std::size_t(1) << maxOrder_);
+    heapAlignment_ = heapStart_ & (~heapStart_ + 1);
+
+    freeBits_ = reinterpret_cast<std::uint64_t*>(bitmapStart);
+    splitBits_ = freeBits_ + words;
+    std::fill(freeBits_, freeBits_ + 2 * words, 0);
+    BuildTree(maxOrder_, 0);
+}
 
-        return reinterpret_cast<void*>(aligned_address);
+void BuddyAllocator::BuildTree(std::size_t order, std::size_t index)
+{
+    //blocks past the end of the heap are never free, their buddies never merge with them
+    const std::size_t firstBlock = index << order;
+    const std::size_t lastBlock = firstBlock + (std::size_t(1) << order);
+    if (firstBlock >= heapBlocks_)
+        return;
+    if (lastBlock <= heapBlocks_)
+    {
+        PushFreeBlock(order, index);
+        return;
     }
+    SetBit(splitBits_, NodeIndex(order, index), true);
+    BuildTree(order - 1, 2 * index);
+    BuildTree(order - 1, 2 * index + 1);
+}
 
-    //ASSERT(false && "Couldn't find free block large enough!"); 
-    return nullptr;
+void BuddyAllocator::SetBit(std::uint64_t* bits, std::size_t node, bool value)
+{
+    const std::uint64_t mask = std::uint64_t(1) << (node % 64);
+    if (value)
+        bits[node / 64] |= mask;
+    else
+        bits[node / 64] &= ~mask;
 }
 
-void FreeListAllocator::Deallocate(void* ptr)
+void BuddyAllocator::PushFreeBlock(std::size_t order, std::size_t index)
+{
+    auto* block = reinterpret_cast<FreeBlock*>(BlockAddress(order, index));
+    block->prev = nullptr;
+    block->next = freeLists_[order];
+    if (block->next != nullptr)
+        block->next->prev = block;
+    freeLists_[order] = block;
+    SetBit(freeBits_, NodeIndex(order, index), true);
+}
+
+void BuddyAllocator::RemoveFreeBlock(std::size_t order, std::size_t index)
+{
+    auto* block = reinterpret_cast<FreeBlock*>(BlockAddress(order, index));
+    if (block->prev != nullptr)
+        block->prev->next = block->next;
+    else
+        freeLists_[order] = block->next;
+    if (block->next != nullptr)
+        block->next->prev = block->prev;
+    SetBit(freeBits_, NodeIndex(order, index), false);
+}
+
+std::size_t BuddyAllocator::GetOrder(std::size_t allocationSize, std::size_t alignment) const
 {
-    const auto* header = reinterpret_cast<AllocationHeader*>(reinterpret_cast<std::uintptr_t>(ptr)- sizeof(AllocationHeader));
-    const std::uintptr_t blockStart = reinterpret_cast<std::uintptr_t>(ptr) - header->adjustment;
-    const std::size_t blockSize = header->allocationSize;
-    const std::uintptr_t blockEnd = blockStart + blockSize;
-    FreeBlock* prevFreeBlock = nullptr;
-    FreeBlock* freeBlock = freeBlocks_;
+    const std::size_t blocks = (std::max(allocationSize, alignment) + minBlockSize_ - 1) / minBlockSize_;
+    return std::bit_width(std::bit_ceil(std::max<std::size_t>(blocks, 1))) - 1;
+}
 
-    while (freeBlock != nullptr)
+void* BuddyAllocator::Allocate(std::size_t allocationSize, std::size_t alignment)
+{
+    const std::size_t order = GetOrder(allocationSize, alignment);
+    //a block is aligned on its size, as long as the heap start is
+    if (heapBlocks_ == 0 || order > maxOrder_ || alignment > heapAlignment_) [[unlikely]]
+    {
+        RecordFailure();
+        return nullptr;
+    }
+    std::size_t freeOrder = order;
+    while (freeOrder <= maxOrder_ && freeLists_[freeOrder] == nullptr)
     {
-        if (reinterpret_cast<std::uintptr_t>(freeBlock) >= blockEnd) break;
-        prevFreeBlock = freeBlock;
-        freeBlock = freeBlock->next;
+        freeOrder++;
+    }
+    if (freeOrder > maxOrder_) [[unlikely]]
+    {
+        RecordFailure();
+        return nullptr;
     }
 
-    if (prevFreeBlock == nullptr)
+    const auto address = reinterpret_cast<std::uintptr_t>(freeLists_[freeOrder]);
+    std::size_t index = (address - heapStart_) / (minBlockSize_ << freeOrder);
+    RemoveFreeBlock(freeOrder, index);
+    //split down to the needed order, the upper halves become free
+    while (freeOrder > order)
     {
-        prevFreeBlock = reinterpret_cast<FreeBlock*>(blockStart);
-        prevFreeBlock->freeSize = blockSize;
-        prevFreeBlock->next = freeBlocks_;
-        freeBlocks_ = prevFreeBlock;
+        SetBit(splitBits_, NodeIndex(freeOrder, index), true);
+        freeOrder--;
+        index *= 2;
+        PushFreeBlock(freeOrder, index + 1);
     }
-    else if (reinterpret_cast<std::uintptr_t>(prevFreeBlock) + prevFreeBlock->freeSize == blockStart)
+
+    usedMemory_ += minBlockSize_ << order;
+    numAllocations_++;
+    RecordAllocation(reinterpret_cast<void*>(address), allocationSize);
+    return reinterpret_cast<void*>(address);
+}
+
+void BuddyAllocator::Deallocate(void* ptr)
+{
+    const std::size_t block = (reinterpret_cast<std::uintptr_t>(ptr) - heapStart_) / minBlockSize_;
+    //the allocated block is the first one up the tree whose parent is split
+    std::size_t order = 0;
+    while (order < maxOrder_ && !GetBit(splitBits_, NodeIndex(order + 1, block >> (order + 1))))
     {
-        prevFreeBlock->freeSize += blockSize;
+        order++;
     }
-    else
+    std::size_t index = block >> order;
+
+    usedMemory_ -= minBlockSize_ << order;
+    numAllocations_--;
+    RecordDeallocation(ptr);
+
+    //merge with the buddy as long as it is free
+    while (order < maxOrder_ && GetBit(freeBits_, NodeIndex(order, index ^ 1)))
+    {
+        RemoveFreeBlock(order, index ^ 1);
+        order++;
+        index /= 2;
+        SetBit(splitBits_, NodeIndex(order, index), false);
+    }
+    PushFreeBlock(order, index);
+}
+
+std::size_t BuddyAllocator::GetFreeBlockCount(std::size_t order) const
+{
+    std::size_t count = 0;
+    for (const FreeBlock* block = order < maxOrders ? freeLists_[order] : nullptr; block != nullptr; block = block->next)
+    {
+        count++;
+    }
+    return count;
+}
+
+PoolAllocator::PoolAllocator(void* rootPtr, std::size_t totalSize, std::size_t objectSize, std::size_t objectAlignment) :
+    Allocator(rootPtr, totalSize),
+    blockAlignment_(std::max(objectAlignment, alignof(FreeBlock)))
+{
+    //a free block must fit the link to the next one, and the next block must stay aligned
+    blockSize_ = std::max(objectSize, sizeof(FreeBlock));
+    blockSize_ = (blockSize_ + blockAlignment_ - 1) & ~(blockAlignment_ - 1);
+
+    const auto adjustment = alignForwardAdjustment(rootPtr, blockAlignment_);
+    const std::size_t blockCount = totalSize > adjustment ? (totalSize - adjustment) / blockSize_ : 0;
+    const auto firstBlock = reinterpret_cast<std::uintptr_t>(rootPtr) + adjustment;
+    //link the blocks in address order
+    for (std::size_t i = blockCount; i > 0; i--)
     {
-        auto* temp = reinterpret_cast<FreeBlock*>(blockStart);
-        temp->freeSize = blockSize;
-        temp->next = prevFreeBlock->next;
-        prevFreeBlock->next = temp;
-        prevFreeBlock = temp;
+        auto* block = reinterpret_cast<FreeBlock*>(firstBlock + (i - 1) * blockSize_);
+        block->next = freeBlocks_;
+        freeBlocks_ = block;
     }
+}
 
-    if (freeBlock != nullptr && reinterpret_cast<std::uintptr_t>(freeBlock) == blockEnd)
+void* PoolAllocator::Allocate(std::size_t allocationSize, std::size_t alignment)
+{
+    if (allocationSize > blockSize_ || alignment > blockAlignment_ || freeBlocks_ == nullptr) [[unlikely]]
     {
-        prevFreeBlock->freeSize += freeBlock->freeSize;
-        prevFreeBlock->next = freeBlock->next;
+        RecordFailure();
+        return nullptr;
     }
 
+    FreeBlock* block = freeBlocks_;
+    freeBlocks_ = block->next;
+    usedMemory_ += blockSize_;
+    numAllocations_++;
+    RecordAllocation(block, allocationSize);
+    return block;
+}
+
+void PoolAllocator::Deallocate(void* ptr)
+{
+    auto* block = static_cast<FreeBlock*>(ptr);
+    block->next = freeBlocks_;
+    freeBlocks_ = block;
+    usedMemory_ -= blockSize_;
     numAllocations_--;
-    usedMemory_ -= blockSize;
+    RecordDeallocation(ptr);
 }
 
-std::uintptr_t FreeListAllocator::AlignForwardAdjustmentWithHeader(const void* address, std::uintptr_t alignment)
+ConcurrentPoolAllocator::ConcurrentPoolAllocator(void* rootPtr, std::size_t totalSize, std::size_t objectSize,
+                                                 std::size_t objectAlignment) :
+    Allocator(rootPtr, totalSize),
+    blockAlignment_(std::max(objectAlignment, alignof(std::uint32_t)))
 {
-    const auto actualAlignment = std::max(alignment, alignof(AllocationHeader));
-    auto adjustment = alignForwardAdjustment(address, actualAlignment);
-    constexpr auto neededSpace = sizeof(AllocationHeader);
-    while (adjustment < neededSpace)
+    blockSize_ = std::max(objectSize, sizeof(std::uint32_t));
+    blockSize_ = (blockSize_ + blockAlignment_ - 1) & ~(blockAlignment_ - 1);
+
+    const auto adjustment = alignForwardAdjustment(rootPtr, blockAlignment_);
+    blockCount_ = totalSize > adjustment ? (totalSize - adjustment) / blockSize_ : 0;
+    blockCount_ = std::min<std::size_t>(blockCount_, invalidIndex);
+    firstBlock_ = reinterpret_cast<std::uintptr_t>(rootPtr) + adjustment;
+    for (std::size_t i = 0; i < blockCount_; i++)
     {
-        adjustment += alignment;
+        NextIndex(static_cast<std::uint32_t>(i)) = i + 1 < blockCount_ ? static_cast<std::uint32_t>(i + 1) : invalidIndex;
     }
-    return adjustment;
+    head_.store(MakeHead(0, blockCount_ > 0 ? 0 : invalidIndex), std::memory_order_release);
+}
+
+std::uint32_t& ConcurrentPoolAllocator::NextIndex(std::uint32_t index) const
+{
+    return *reinterpret_cast<std::uint32_t*>(firstBlock_ + index * blockSize_);
+}
+
+void* ConcurrentPoolAllocator::Allocate(std::size_t allocationSize, std::size_t alignment)
+{
+    if (allocationSize > blockSize_ || alignment > blockAlignment_) [[unlikely]]
+        return nullptr;
+
+    std::uint64_t head = head_.load(std::memory_order_acquire);
+    while (true)
+    {
+        const auto index = static_cast<std::uint32_t>(head);
+        if (index == invalidIndex) [[unlikely]]
+            return nullptr;
+        //the block may already be taken by another thread, then the tag changed and the exchange fails
+        const std::uint32_t next = std::atomic_ref<std::uint32_t>(NextIndex(index)).load(std::memory_order_relaxed);
+        if (head_.compare_exchange_weak(head, MakeHead((head >> 32) + 1, next),
+                                        std::memory_order_acquire, std::memory_order_acquire))
+        {
+            return reinterpret_cast<void*>(firstBlock_ + index * blockSize_);
+        }
+    }
+}
+
+void ConcurrentPoolAllocator::Deallocate(void* ptr)
+{
+    const auto index = static_cast<std::uint32_t>((reinterpret_cast<std::uintptr_t>(ptr) - firstBlock_) / blockSize_);
+    std::uint64_t head = head_.load(std::memory_order_relaxed);
+    do
+    {
+        std::atomic_ref<std::uint32_t>(NextIndex(index)).store(static_cast<std::uint32_t>(head), std::memory_order_relaxed);
+    } while (!head_.compare_exchange_weak(head, MakeHead((head >> 32) + 1, index),
+                                           std::memory_order_release, std::memory_order_relaxed));
+}
+
+ThreadCachingAllocator::ThreadCachingAllocator(Allocator& backing) :
+    Allocator(nullptr, backing.GetTotalSize()),
+    backing_(backing),
+    caches_(std::make_unique<ThreadCache[]>(maxCaches))
+{
+}
+
+ThreadCachingAllocator::~ThreadCachingAllocator()
+{
+    for (std::size_t i = 0; i < maxCaches; i++)
+    {
+        FlushCache(caches_[i]);
+    }
+}
+
+std::size_t ThreadCachingAllocator::GetSizeClass(std::size_t allocationSize)
+{
+    if (allocationSize <= minClassSize)
+        return 0;
+    return std::bit_width(allocationSize - 1) - std::bit_width(minClassSize - 1);
+}
+
+ThreadCachingAllocator::ThreadCache& ThreadCachingAllocator::GetThreadCache() const
+{
+    return caches_[ThreadShardIndex() % maxCaches];
+}
+
+void* ThreadCachingAllocator::Allocate(std::size_t allocationSize, std::size_t alignment)
+{
+    if (allocationSize > maxClassSize || alignment > headerSize) [[unlikely]]
+    {
+        //the header sits in the alignment padding
+        const std::size_t offset = std::max(alignment, headerSize);
+        void* block;
+        {
+            std::lock_guard<SpinLock> lock(backingLock_);
+            block = backing_.Allocate(allocationSize + offset, offset);
+        }
+        if (block == nullptr)
+            return nullptr;
+        void* ptr = static_cast<char*>(block) + offset;
+        GetHeader(ptr) = { largeClass, static_cast<std::uint32_t>(offset) };
+        return ptr;
+    }
+
+    const std::size_t sizeClass = GetSizeClass(allocationSize);
+    ThreadCache& cache = GetThreadCache();
+    std::lock_guard<SpinLock> lock(cache.lock);
+    Magazine& magazine = cache.magazines[sizeClass];
+    if (magazine.count == 0 && !Refill(magazine, sizeClass)) [[unlikely]]
+        return nullptr;
+    return magazine.blocks[--magazine.count];
+}
+
+void ThreadCachingAllocator::Deallocate(void* ptr)
+{
+    const AllocationHeader header = GetHeader(ptr);
+    if (header.sizeClass == largeClass) [[unlikely]]
+    {
+        std::lock_guard<SpinLock> lock(backingLock_);
+        backing_.Deallocate(static_cast<char*>(ptr) - header.offset);
+        return;
+    }
+
+    ThreadCache& cache = GetThreadCache();
+    std::lock_guard<SpinLock> lock(cache.lock);
+    Magazine& magazine = cache.magazines[header.sizeClass];
+    if (magazine.count == magazineCapacity) [[unlikely]]
+    {
+        //keep a batch for the next allocations
+        Flush(magazine, batchSize);
+    }
+    magazine.blocks[magazine.count++] = ptr;
+}
+
+bool ThreadCachingAllocator::Refill(Magazine& magazine, std::size_t sizeClass)
+{
+    const std::size_t blockSize = GetClassSize(sizeClass) + headerSize;
+    std::lock_guard<SpinLock> lock(backingLock_);
+    while (magazine.count < batchSize)
+    {
+        void* block = backing_.Allocate(blockSize, headerSize);
+        if (block == nullptr)
+            break;
+        void* ptr = static_cast<char*>(block) + headerSize;
+        GetHeader(ptr) = { static_cast<std::uint32_t>(sizeClass), static_cast<std::uint32_t>(headerSize) };
+        magazine.blocks[magazine.count++] = ptr;
+    }
+    return magazine.count > 0;
+}
+
+void ThreadCachingAllocator::Flush(Magazine& magazine, std::size_t count)
+{
+    std::lock_guard<SpinLock> lock(backingLock_);
+    for (std::size_t i = 0; i < count && magazine.count > 0; i++)
+    {
+        backing_.Deallocate(static_cast<char*>(magazine.blocks[--magazine.count]) - headerSize);
+    }
+}
+
+void ThreadCachingAllocator::FlushCache(ThreadCache& cache)
+{
+    std::lock_guard<SpinLock> lock(cache.lock);
+    for (auto& magazine : cache.magazines)
+    {
+        Flush(magazine, magazine.count);
+    }
+}
+
+void ThreadCachingAllocator::FlushThreadCache()
+{
+    FlushCache(GetThreadCache());
 }
@@ -0,0 +1,209 @@
+#include "epoch_reclamation.h"
+
+#include <thread>
+
+namespace JobSystem
+{
+	thread_local EpochManager::ThreadSlot EpochManager::threadSlot_;
+
+	EpochManager::ThreadSlot::~ThreadSlot()
+	{
+		if (slot != nullptr)
+		{
+			EpochManager::Get().UnregisterThread();
+		}
+	}
+
+	EpochManager& EpochManager::Get()
+	{
+		static EpochManager manager;
+		return manager;
+	}
+
+	bool EpochManager::RegisterThread()
+	{
+		if (threadSlot_.slot != nullptr)
+		{
+			return true;
+		}
+		for (auto& slot : slots_)
+		{
+			bool expected = false;
+			if (slot.inUse.compare_exchange_strong(expected, true, std::memory_order_acq_rel))
+			{
+				threadSlot_.slot = &slot;
+				return true;
+			}
+		}
+		return false;
+	}
+
+	void EpochManager::UnregisterThread()
+	{
+		Slot* slot = threadSlot_.slot;
+		if (slot == nullptr)
+		{
+			return;
+		}
+		slot->state.store(0, std::memory_order_release);
+		slot->depth = 0;
+		slot->retiredCount = 0;
+		{
+			// the objects still waiting are adopted by the threads calling Collect
+			std::lock_guard<std::mutex> lock(orphanLock_);
+			for (auto& limbo : slot->limbo)
+			{
+				if (!limbo.objects.empty())
+				{
+					orphans_.push_back(std::move(limbo));
+					limbo.objects.clear();
+				}
+			}
+			hasOrphans_.store(!orphans_.empty(), std::memory_order_release);
+		}
+		threadSlot_.slot = nullptr;
+		slot->inUse.store(false, std::memory_order_release);
+	}
+
+	EpochManager::Slot* EpochManager::GetSlot()
+	{
+		// a thread that never registered gets a slot on its first use, waiting if they are all taken
+		while (threadSlot_.slot == nullptr && !RegisterThread())
+		{
+			std::this_thread::yield();
+		}
+		return threadSlot_.slot;
+	}
+
+	void EpochManager::Enter()
+	{
+		Slot* slot = GetSlot();
+		if (slot->depth++ == 0)
+		{
+			Quiesce();
+		}
+	}
+
+	void EpochManager::Exit()
+	{
+		Slot* slot = threadSlot_.slot;
+		if (--slot->depth == 0)
+		{
+			slot->state.store(0, std::memory_order_release);
+			if (slot->retiredCount > 0)
+			{
+				TryAdvance();
+				Collect();
+			}
+		}
+	}
+
+	void EpochManager::Quiesce()
+	{
+		Slot* slot = threadSlot_.slot;
+		if (slot == nullptr || slot->depth == 0)
+		{
+			return;
+		}
+		// publish the epoch, again if it moved before the publication was visible
+		std::uint64_t epoch = globalEpoch_.load(std::memory_order_acquire);
+		while (true)
+		{
+			slot->state.store((epoch << 1) | 1, std::memory_order_seq_cst);
+			const std::uint64_t current = globalEpoch_.load(std::memory_order_seq_cst);
+			if (current == epoch)
+			{
+				break;
+			}
+			epoch = current;
+		}
+	}
+
+	void EpochManager::Retire(void* ptr, Deleter deleter)
+	{
+		Slot* slot = GetSlot();
+		const std::uint64_t epoch = globalEpoch_.load(std::memory_order_acquire);
+		Limbo& limbo = slot->limbo[epoch % 3];
+		if (limbo.epoch != epoch)
+		{
+			// this bucket holds objects at least three epochs old
+			slot->retiredCount -= limbo.objects.size();
+			Free(limbo);
+			limbo.epoch = epoch;
+		}
+		limbo.objects.push_back({ ptr, deleter });
+		slot->retiredCount++;
+
+		if (slot->retiredCount >= retireBatch)
+		{
+			TryAdvance();
+			Collect();
+		}
+	}
+
+	bool EpochManager::TryAdvance()
+	{
+		std::uint64_t epoch = globalEpoch_.load(std::memory_order_seq_cst);
+		for (const auto& slot : slots_)
+		{
+			if (!slot.inUse.load(std::memory_order_acquire))
+			{
+				continue;
+			}
+			const std::uint64_t state = slot.state.load(std::memory_order_seq_cst);
+			if ((state & 1) != 0 && (state >> 1) != epoch)
+			{
+				return false;
+			}
+		}
+		return globalEpoch_.compare_exchange_strong(epoch, epoch + 1, std::memory_order_seq_cst);
+	}
+
+	void EpochManager::Collect()
+	{
+		const std::uint64_t epoch = globalEpoch_.load(std::memory_order_acquire);
+		if (Slot* slot = threadSlot_.slot)
+		{
+			for (auto& limbo : slot->limbo)
+			{
+				if (!limbo.objects.empty() && limbo.epoch + 2 <= epoch)
+				{
+					slot->retiredCount -= limbo.objects.size();
+					Free(limbo);
+				}
+			}
+		}
+		if (hasOrphans_.load(std::memory_order_acquire))
+		{
+			CollectOrphans();
+		}
+	}
+
+	void EpochManager::Free(Limbo& limbo)
+	{
+		for (const auto& retired : limbo.objects)
+		{
+			retired.deleter(retired.ptr);
+		}
+		limbo.objects.clear();
+	}
+
+	void EpochManager::CollectOrphans()
+	{
+		std::lock_guard<std::mutex> lock(orphanLock_);
+		const std::uint64_t epoch = globalEpoch_.load(std::memory_order_acquire);
+		for (auto it = orphans_.begin(); it != orphans_.end();)
+		{
+			if (it->epoch + 2 <= epoch)
+			{
+				Free(*it);
+				it = orphans_.erase(it);
+			}
+			else
+			{
+				++it;
+			}
+		}
+		hasOrphans_.store(!orphans_.empty(), std::memory_order_release);
+	}
+}
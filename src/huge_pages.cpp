@@ -0,0 +1,90 @@
+#include "huge_pages.h"
+
+#include <cstdint>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <Windows.h>
+#else
+#include <sys/mman.h>
+#endif
+
+void* AllocateHugePages(std::size_t size, HugePageMode* mode)
+{
+    size = RoundToHugePages(size);
+    HugePageMode usedMode = HugePageMode::None;
+#ifdef _WIN32
+    //needs the SeLockMemoryPrivilege, without it windows gives regular pages
+    void* region = nullptr;
+    if (GetLargePageMinimum() == hugePageSize)
+    {
+        region = VirtualAlloc(nullptr, size, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE);
+        usedMode = HugePageMode::Explicit;
+    }
+    if (region == nullptr)
+    {
+        region = VirtualAlloc(nullptr, size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+        usedMode = HugePageMode::None;
+    }
+#else
+    void* region = MAP_FAILED;
+#ifdef MAP_HUGETLB
+    region = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    usedMode = HugePageMode::Explicit;
+#endif
+    if (region == MAP_FAILED)
+    {
+        //no huge page pool, transparent huge pages on an aligned range
+        bool transparent = false;
+        region = MapHugePageAligned(size, false, &transparent);
+        if (region == nullptr)
+        {
+            return nullptr;
+        }
+        usedMode = transparent ? HugePageMode::Transparent : HugePageMode::None;
+    }
+#endif
+    if (mode != nullptr)
+    {
+        *mode = usedMode;
+    }
+    return region;
+}
+
+void FreeHugePages(void* ptr, std::size_t size)
+{
+    if (ptr == nullptr)
+        return;
+#ifdef _WIN32
+    VirtualFree(ptr, 0, MEM_RELEASE);
+#else
+    munmap(ptr, RoundToHugePages(size));
+#endif
+}
+
+#ifndef _WIN32
+void* MapHugePageAligned(std::size_t size, bool reserveOnly, bool* transparent)
+{
+    //map one more huge page and trim the ends
+    const std::size_t mappedSize = size + hugePageSize;
+    const int protection = reserveOnly ? PROT_NONE : PROT_READ | PROT_WRITE;
+    const int flags = MAP_PRIVATE | MAP_ANONYMOUS | (reserveOnly ? MAP_NORESERVE : 0);
+    void* mapped = mmap(nullptr, mappedSize, protection, flags, -1, 0);
+    if (mapped == MAP_FAILED)
+    {
+        return nullptr;
+    }
+    auto* start = static_cast<char*>(mapped);
+    const std::size_t head = (hugePageSize - reinterpret_cast<std::uintptr_t>(start) % hugePageSize) % hugePageSize;
+    if (head > 0)
+    {
+        munmap(start, head);
+    }
+    munmap(start + head + size, hugePageSize - head);
+    *transparent = false;
+#ifdef MADV_HUGEPAGE
+    *transparent = madvise(start + head, size, MADV_HUGEPAGE) == 0;
+#endif
+    return start + head;
+}
+#endif
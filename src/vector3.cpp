@@ -59,21 +59,21 @@ template<>
 FourVec3f FourVec3f::operator+(const FourVec3f& v) const
 {
     FourVec3f fv3f;
-    auto x1 = _mm_loadu_ps(xs.data());
-    auto y1 = _mm_loadu_ps(ys.data());
-    auto z1 = _mm_loadu_ps(zs.data());
+    auto x1 = _mm_load_ps(xs.data());
+    auto y1 = _mm_load_ps(ys.data());
+    auto z1 = _mm_load_ps(zs.data());
 
-    const auto x2 = _mm_loadu_ps(v.xs.data());
-    const auto y2 = _mm_loadu_ps(v.ys.data());
-    const auto z2 = _mm_loadu_ps(v.zs.data());
+    const auto x2 = _mm_load_ps(v.xs.data());
+    const auto y2 = _mm_load_ps(v.ys.data());
+    const auto z2 = _mm_load_ps(v.zs.data());
 
     x1 = _mm_add_ps(x1, x2);
     y1 = _mm_add_ps(y1, y2);
     z1 = _mm_add_ps(z1, z2);
 
-    _mm_storeu_ps(fv3f.xs.data(), x1);
-    _mm_storeu_ps(fv3f.ys.data(), y1);
-    _mm_storeu_ps(fv3f.zs.data(), z1);
+    _mm_store_ps(fv3f.xs.data(), x1);
+    _mm_store_ps(fv3f.ys.data(), y1);
+    _mm_store_ps(fv3f.zs.data(), z1);
     return fv3f;
 }
 
@@ -82,21 +82,21 @@ template<>
 FourVec3f FourVec3f::operator-(const FourVec3f& v) const
 {
     FourVec3f fv3f;
-    auto x1 = _mm_loadu_ps(xs.data());
-    auto y1 = _mm_loadu_ps(ys.data());
-    auto z1 = _mm_loadu_ps(zs.data());
+    auto x1 = _mm_load_ps(xs.data());
+    auto y1 = _mm_load_ps(ys.data());
+    auto z1 = _mm_load_ps(zs.data());
 
-    const auto x2 = _mm_loadu_ps(v.xs.data());
-    const auto y2 = _mm_loadu_ps(v.ys.data());
-    const auto z2 = _mm_loadu_ps(v.zs.data());
+    const auto x2 = _mm_load_ps(v.xs.data());
+    const auto y2 = _mm_load_ps(v.ys.data());
+    const auto z2 = _mm_load_ps(v.zs.data());
 
     x1 = _mm_sub_ps(x1, x2);
     y1 = _mm_sub_ps(y1, y2);
     z1 = _mm_sub_ps(z1, z2);
 
-    _mm_storeu_ps(fv3f.xs.data(), x1);
-    _mm_storeu_ps(fv3f.ys.data(), y1);
-    _mm_storeu_ps(fv3f.zs.data(), z1);
+    _mm_store_ps(fv3f.xs.data(), x1);
+    _mm_store_ps(fv3f.ys.data(), y1);
+    _mm_store_ps(fv3f.zs.data(), z1);
     return fv3f;
 }
 
@@ -105,18 +105,18 @@ template<>
 FourVec3f FourVec3f::operator*(const FourFloat& rhs) const
 {
     FourVec3f result;
-    auto x = _mm_loadu_ps(xs.data());
-    auto y = _mm_loadu_ps(ys.data());
-    auto z = _mm_loadu_ps(zs.data());
-    const auto v = _mm_loadu_ps(&rhs[0]);
+    auto x = _mm_load_ps(xs.data());
+    auto y = _mm_load_ps(ys.data());
+    auto z = _mm_load_ps(zs.data());
+    const auto v = _mm_load_ps(&rhs[0]);
 
     x = _mm_mul_ps(x, v);
     y = _mm_mul_ps(y, v);
     z = _mm_mul_ps(z, v);
 
-    _mm_storeu_ps(result.Xs().data(), x);
-    _mm_storeu_ps(result.Ys().data(), y);
-    _mm_storeu_ps(result.Zs().data(), z);
+    _mm_store_ps(result.Xs().data(), x);
+    _mm_store_ps(result.Ys().data(), y);
+    _mm_store_ps(result.Zs().data(), z);
     return result;
 
 }
@@ -125,18 +125,18 @@ template<>
 FourVec3f FourVec3f::operator/(const FourFloat& rhs) const
 {
     FourVec3f result;
-    auto x = _mm_loadu_ps(xs.data());
-    auto y = _mm_loadu_ps(ys.data());
-    auto z = _mm_loadu_ps(zs.data());
-    const auto v = _mm_loadu_ps(&rhs[0]);
+    auto x = _mm_load_ps(xs.data());
+    auto y = _mm_load_ps(ys.data());
+    auto z = _mm_load_ps(zs.data());
+    const auto v = _mm_load_ps(&rhs[0]);
 
     x = _mm_div_ps(x, v);
     y = _mm_div_ps(y, v);
     z = _mm_div_ps(z, v);
 
-    _mm_storeu_ps(result.Xs().data(), x);
-    _mm_storeu_ps(result.Ys().data(), y);
-    _mm_storeu_ps(result.Zs().data(), z);
+    _mm_store_ps(result.Xs().data(), x);
+    _mm_store_ps(result.Ys().data(), y);
+    _mm_store_ps(result.Zs().data(), z);
     return result;
 }
 
@@ -144,30 +144,30 @@ template<>
 FourVec3f FourVec3f::operator*(float value) const
 {
     FourVec3f result;
-    auto x = _mm_loadu_ps(xs.data());
-    auto y = _mm_loadu_ps(ys.data());
-    auto z = _mm_loadu_ps(zs.data());
+    auto x = _mm_load_ps(xs.data());
+    auto y = _mm_load_ps(ys.data());
+    auto z = _mm_load_ps(zs.data());
     const auto v = _mm_load1_ps(&value);
 
     x = _mm_mul_ps(x, v);
     y = _mm_mul_ps(y, v);
     z = _mm_mul_ps(z, v);
 
-    _mm_storeu_ps(result.Xs().data(), x);
-    _mm_storeu_ps(result.Ys().data(), y);
-    _mm_storeu_ps(result.Zs().data(), z);
+    _mm_store_ps(result.Xs().data(), x);
+    _mm_store_ps(result.Ys().data(), y);
+    _mm_store_ps(result.Zs().data(), z);
     return result;
 }
 template<>
 FourFloat FourVec3f::Dot(const FourVec3f& v1, const FourVec3f& v2)
 {
-    auto x1 = _mm_loadu_ps(v1.xs.data());
-    auto y1 = _mm_loadu_ps(v1.ys.data());
-    auto z1 = _mm_loadu_ps(v1.zs.data());
+    auto x1 = _mm_load_ps(v1.xs.data());
+    auto y1 = _mm_load_ps(v1.ys.data());
+    auto z1 = _mm_load_ps(v1.zs.data());
 
-    auto x2 = _mm_loadu_ps(v2.xs.data());
-    auto y2 = _mm_loadu_ps(v2.ys.data());
-    auto z2 = _mm_loadu_ps(v2.zs.data());
+    auto x2 = _mm_load_ps(v2.xs.data());
+    auto y2 = _mm_load_ps(v2.ys.data());
+    auto z2 = _mm_load_ps(v2.zs.data());
 
     x1 = _mm_mul_ps(x1, x2);
     y1 = _mm_mul_ps(y1, y2);
@@ -177,15 +177,15 @@ FourFloat FourVec3f::Dot(const FourVec3f& v1, const FourVec3f& v2)
     x1 = _mm_add_ps(x1, z1);
 
     FourFloat result;
-    _mm_storeu_ps(&result[0], x1);
+    _mm_store_ps(&result[0], x1);
     return result;
 }
 template<>
 FourFloat FourVec3f::Magnitude() const
 {
-    auto x1 = _mm_loadu_ps(xs.data());
-    auto y1 = _mm_loadu_ps(ys.data());
-    auto z1 = _mm_loadu_ps(zs.data());
+    auto x1 = _mm_load_ps(xs.data());
+    auto y1 = _mm_load_ps(ys.data());
+    auto z1 = _mm_load_ps(zs.data());
 
     x1 = _mm_mul_ps(x1, x1);
     y1 = _mm_mul_ps(y1, y1);
@@ -196,7 +196,7 @@ FourFloat FourVec3f::Magnitude() const
     x1 = _mm_sqrt_ps(x1);
 
     FourFloat result;
-    _mm_storeu_ps(&result[0], x1);
+    _mm_store_ps(&result[0], x1);
     return result;
 }
 #endif
@@ -365,21 +365,21 @@ EightVec3f EightVec3f::operator+(const EightVec3f& v) const
 {
     EightVec3f result;
 
-    auto x1 = _mm256_loadu_ps(xs.data());
-    auto y1 = _mm256_loadu_ps(xs.data());
-    auto z1 = _mm256_loadu_ps(xs.data());
+    auto x1 = _mm256_load_ps(xs.data());
+    auto y1 = _mm256_load_ps(ys.data());
+    auto z1 = _mm256_load_ps(zs.data());
 
-    const auto x2 = _mm256_loadu_ps(v.xs.data());
-    const auto y2 = _mm256_loadu_ps(v.xs.data());
-    const auto z2 = _mm256_loadu_ps(v.xs.data());
+    const auto x2 = _mm256_load_ps(v.xs.data());
+    const auto y2 = _mm256_load_ps(v.ys.data());
+    const auto z2 = _mm256_load_ps(v.zs.data());
 
     x1 = _mm256_add_ps(x1, x2);
     y1 = _mm256_add_ps(y1, y2);
     z1 = _mm256_add_ps(z1, z2);
 
-    _mm256_storeu_ps(result.xs.data(), x1);
-    _mm256_storeu_ps(result.ys.data(), y1);
-    _mm256_storeu_ps(result.zs.data(), z1);
+    _mm256_store_ps(result.xs.data(), x1);
+    _mm256_store_ps(result.ys.data(), y1);
+    _mm256_store_ps(result.zs.data(), z1);
 
     return result;
 }
@@ -388,21 +388,21 @@ EightVec3f EightVec3f::operator-(const EightVec3f& v) const
 {
     EightVec3f result;
 
-    auto x1 = _mm256_loadu_ps(xs.data());
-    auto y1 = _mm256_loadu_ps(xs.data());
-    auto z1 = _mm256_loadu_ps(xs.data());
+    auto x1 = _mm256_load_ps(xs.data());
+    auto y1 = _mm256_load_ps(ys.data());
+    auto z1 = _mm256_load_ps(zs.data());
 
-    const auto x2 = _mm256_loadu_ps(v.xs.data());
-    const auto y2 = _mm256_loadu_ps(v.xs.data());
-    const auto z2 = _mm256_loadu_ps(v.xs.data());
+    const auto x2 = _mm256_load_ps(v.xs.data());
+    const auto y2 = _mm256_load_ps(v.ys.data());
+    const auto z2 = _mm256_load_ps(v.zs.data());
 
     x1 = _mm256_sub_ps(x1, x2);
     y1 = _mm256_sub_ps(y1, y2);
     z1 = _mm256_sub_ps(z1, z2);
 
-    _mm256_storeu_ps(result.xs.data(), x1);
-    _mm256_storeu_ps(result.ys.data(), y1);
-    _mm256_storeu_ps(result.zs.data(), z1);
+    _mm256_store_ps(result.xs.data(), x1);
+    _mm256_store_ps(result.ys.data(), y1);
+    _mm256_store_ps(result.zs.data(), z1);
 
     return result;
 }
@@ -410,66 +410,66 @@ template<>
 EightVec3f EightVec3f::operator*(const EightFloat& rhs) const
 {
     EightVec3f result;
-    auto x = _mm256_loadu_ps(xs.data());
-    auto y = _mm256_loadu_ps(ys.data());
-    auto z = _mm256_loadu_ps(zs.data());
-    const auto v = _mm256_loadu_ps(&rhs[0]);
+    auto x = _mm256_load_ps(xs.data());
+    auto y = _mm256_load_ps(ys.data());
+    auto z = _mm256_load_ps(zs.data());
+    const auto v = _mm256_load_ps(&rhs[0]);
 
     x = _mm256_mul_ps(x, v);
     y = _mm256_mul_ps(y, v);
     z = _mm256_mul_ps(z, v);
 
-    _mm256_storeu_ps(result.Xs().data(), x);
-    _mm256_storeu_ps(result.Ys().data(), y);
-    _mm256_storeu_ps(result.Zs().data(), z);
+    _mm256_store_ps(result.Xs().data(), x);
+    _mm256_store_ps(result.Ys().data(), y);
+    _mm256_store_ps(result.Zs().data(), z);
     return result;
 }
 template<>
 EightVec3f EightVec3f::operator*(float value) const
 {
     EightVec3f result;
-    auto x = _mm256_loadu_ps(xs.data());
-    auto y = _mm256_loadu_ps(ys.data());
-    auto z = _mm256_loadu_ps(zs.data());
+    auto x = _mm256_load_ps(xs.data());
+    auto y = _mm256_load_ps(ys.data());
+    auto z = _mm256_load_ps(zs.data());
     const auto v = _mm256_broadcast_ss(&value);
 
     x = _mm256_mul_ps(x, v);
     y = _mm256_mul_ps(y, v);
     z = _mm256_mul_ps(z, v);
 
-    _mm256_storeu_ps(result.Xs().data(), x);
-    _mm256_storeu_ps(result.Ys().data(), y);
-    _mm256_storeu_ps(result.Zs().data(), z);
+    _mm256_store_ps(result.Xs().data(), x);
+    _mm256_store_ps(result.Ys().data(), y);
+    _mm256_store_ps(result.Zs().data(), z);
     return result;
 }
 template<>
 EightVec3f EightVec3f::operator/(const EightFloat& values) const
 {
     EightVec3f result;
-    auto x = _mm256_loadu_ps(xs.data());
-    auto y = _mm256_loadu_ps(ys.data());
-    auto z = _mm256_loadu_ps(zs.data());
-    const auto v = _mm256_loadu_ps(&values[0]);
+    auto x = _mm256_load_ps(xs.data());
+    auto y = _mm256_load_ps(ys.data());
+    auto z = _mm256_load_ps(zs.data());
+    const auto v = _mm256_load_ps(&values[0]);
 
     x = _mm256_div_ps(x, v);
     y = _mm256_div_ps(y, v);
     z = _mm256_div_ps(z, v);
 
-    _mm256_storeu_ps(result.Xs().data(), x);
-    _mm256_storeu_ps(result.Ys().data(), y);
-    _mm256_storeu_ps(result.Zs().data(), z);
+    _mm256_store_ps(result.Xs().data(), x);
+    _mm256_store_ps(result.Ys().data(), y);
+    _mm256_store_ps(result.Zs().data(), z);
     return result;
 }
 template<>
 EightFloat EightVec3f::Dot(const EightVec3f& v1, const EightVec3f& v2)
 {
-    auto x1 = _mm256_loadu_ps(v1.xs.data());
-    auto y1 = _mm256_loadu_ps(v1.ys.data());
-    auto z1 = _mm256_loadu_ps(v1.zs.data());
+    auto x1 = _mm256_load_ps(v1.xs.data());
+    auto y1 = _mm256_load_ps(v1.ys.data());
+    auto z1 = _mm256_load_ps(v1.zs.data());
 
-    auto x2 = _mm256_loadu_ps(v2.xs.data());
-    auto y2 = _mm256_loadu_ps(v2.ys.data());
-    auto z2 = _mm256_loadu_ps(v2.zs.data());
+    auto x2 = _mm256_load_ps(v2.xs.data());
+    auto y2 = _mm256_load_ps(v2.ys.data());
+    auto z2 = _mm256_load_ps(v2.zs.data());
 
     x1 = _mm256_mul_ps(x1, x2);
     y1 = _mm256_mul_ps(y1, y2);
@@ -479,15 +479,15 @@ EightFloat EightVec3f::Dot(const EightVec3f& v1, const EightVec3f& v2)
     x1 = _mm256_add_ps(x1, z1);
 
     EightFloat result;
-    _mm256_storeu_ps(&result[0], x1);
+    _mm256_store_ps(&result[0], x1);
     return result;
 }
 template<>
 EightFloat EightVec3f::Magnitude() const
 {
-    auto x1 = _mm256_loadu_ps(xs.data());
-    auto y1 = _mm256_loadu_ps(ys.data());
-    auto z1 = _mm256_loadu_ps(zs.data());
+    auto x1 = _mm256_load_ps(xs.data());
+    auto y1 = _mm256_load_ps(ys.data());
+    auto z1 = _mm256_load_ps(zs.data());
 
     x1 = _mm256_mul_ps(x1, x1);
     y1 = _mm256_mul_ps(y1, y1);
@@ -498,7 +498,7 @@ EightFloat EightVec3f::Magnitude() const
     x1 = _mm256_sqrt_ps(x1);
 
     EightFloat result;
-    _mm256_storeu_ps(&result[0], x1);
+    _mm256_store_ps(&result[0], x1);
     return result;
 }
 
@@ -0,0 +1,129 @@
+#include "virtual_arena.h"
+#include "huge_pages.h"
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <Windows.h>
+#else
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+    std::size_t RoundToPages(std::size_t size, bool hugePages)
+    {
+        const std::size_t pageSize = hugePages ? hugePageSize : VirtualArena::GetPageSize();
+        return (size + pageSize - 1) / pageSize * pageSize;
+    }
+
+    //usesHugePages receives whether the range gets huge pages
+    void* Reserve(std::size_t size, [[maybe_unused]] bool hugePages, bool* usesHugePages)
+    {
+        *usesHugePages = false;
+#ifdef _WIN32
+        //large pages can't be committed on demand, the flag is ignored
+        return VirtualAlloc(nullptr, size, MEM_RESERVE, PAGE_NOACCESS);
+#else
+        if (!hugePages)
+        {
+            void* region = mmap(nullptr, size, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+            return region == MAP_FAILED ? nullptr : region;
+        }
+        return MapHugePageAligned(size, true, usesHugePages);
+#endif
+    }
+}
+
+std::size_t VirtualArena::GetPageSize()
+{
+#ifdef _WIN32
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    static const std::size_t pageSize = info.dwPageSize;
+#else
+    static const std::size_t pageSize = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+#endif
+    return pageSize;
+}
+
+VirtualArena::VirtualArena(std::size_t reserveSize, std::size_t commitChunk, bool hugePages) :
+    Allocator(nullptr, RoundToPages(reserveSize, hugePages)),
+    commitChunk_(RoundToPages(commitChunk, hugePages))
+{
+    rootPtr_ = Reserve(totalSize_, hugePages, &hugePages_);
+    if (rootPtr_ == nullptr)
+    {
+        totalSize_ = 0;
+    }
+}
+
+VirtualArena::~VirtualArena()
+{
+    if (rootPtr_ == nullptr)
+        return;
+#ifdef _WIN32
+    VirtualFree(rootPtr_, 0, MEM_RELEASE);
+#else
+    munmap(rootPtr_, totalSize_);
+#endif
+}
+
+bool VirtualArena::Commit(std::size_t size)
+{
+    //grow by whole chunks, the last one may be cut by the end of the reserved range
+    std::size_t newCommittedSize = (size + commitChunk_ - 1) / commitChunk_ * commitChunk_;
+    newCommittedSize = std::min(newCommittedSize, totalSize_);
+    char* start = static_cast<char*>(rootPtr_) + committedSize_;
+    const std::size_t length = newCommittedSize - committedSize_;
+#ifdef _WIN32
+    if (VirtualAlloc(start, length, MEM_COMMIT, PAGE_READWRITE) == nullptr)
+        return false;
+#else
+    if (mprotect(start, length, PROT_READ | PROT_WRITE) != 0)
+        return false;
+#endif
+    committedSize_ = newCommittedSize;
+    return true;
+}
+
+void* VirtualArena::Allocate(std::size_t allocationSize, std::size_t alignment)
+{
+    const auto current = reinterpret_cast<std::uintptr_t>(rootPtr_) + offset_;
+    const auto alignedAddress = reinterpret_cast<std::uintptr_t>(alignForward(reinterpret_cast<void*>(current), alignment));
+    const std::size_t end = alignedAddress + allocationSize - reinterpret_cast<std::uintptr_t>(rootPtr_);
+    if (end > totalSize_ || (end > committedSize_ && !Commit(end))) [[unlikely]]
+    {
+        RecordFailure();
+        return nullptr;
+    }
+
+    usedMemory_ += end - offset_;
+    offset_ = end;
+    numAllocations_++;
+    RecordArenaAllocation(allocationSize);
+    return reinterpret_cast<void*>(alignedAddress);
+}
+
+void VirtualArena::Deallocate(void* ptr)
+{
+}
+
+void VirtualArena::Reset(bool releasePages)
+{
+    offset_ = 0;
+    usedMemory_ = 0;
+    numAllocations_ = 0;
+    if (releasePages && committedSize_ > 0)
+    {
+#ifdef _WIN32
+        VirtualFree(rootPtr_, committedSize_, MEM_DECOMMIT);
+#else
+        //the pages are dropped now, protecting the range again makes a later access fault like on windows
+        madvise(rootPtr_, committedSize_, MADV_DONTNEED);
+        mprotect(rootPtr_, committedSize_, PROT_NONE);
+#endif
+        committedSize_ = 0;
+    }
+    RecordArenaReset();
+}
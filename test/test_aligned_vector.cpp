@@ -0,0 +1,77 @@
+#include <aligned_vector.h>
+#include <matrix4.h>
+#include <vector3.h>
+#include <gtest/gtest.h>
+#include <cstdint>
+
+TEST(AlignedVector, Alignment)
+{
+    for (std::size_t size = 1; size < 100; size += 7)
+    {
+        AlignedVector<float> floats(size);
+        EXPECT_EQ(reinterpret_cast<std::uintptr_t>(floats.data()) % simdAlignment, 0u);
+        AlignedVector<char, 64> chars(size);
+        EXPECT_EQ(reinterpret_cast<std::uintptr_t>(chars.data()) % 64, 0u);
+    }
+    AlignedVector<maths::Mat4f, 16> matrices(3);
+    for (const auto& matrix : matrices)
+    {
+        EXPECT_EQ(reinterpret_cast<std::uintptr_t>(&matrix) % 16, 0u);
+    }
+    //the growth keeps the alignment
+    AlignedVector<double> numbers;
+    for (int i = 0; i < 1000; i++)
+    {
+        numbers.push_back(i);
+        ASSERT_EQ(reinterpret_cast<std::uintptr_t>(numbers.data()) % simdAlignment, 0u);
+    }
+    EXPECT_EQ(numbers[999], 999.0);
+}
+
+TEST(AlignedVector, Padding)
+{
+    EXPECT_EQ(LaneCount<float>(), simdAlignment / sizeof(float));
+    EXPECT_EQ(PadToLanes<float>(1), LaneCount<float>());
+    EXPECT_EQ(PadToLanes<float>(LaneCount<float>()), LaneCount<float>());
+    EXPECT_EQ(PadToLanes<float>(LaneCount<float>() + 1), 2 * LaneCount<float>());
+    //the storage always ends on a whole register
+    EXPECT_EQ((AlignedAllocator<float, 32>::PaddedSize(1)), 32u);
+    EXPECT_EQ((AlignedAllocator<float, 32>::PaddedSize(8)), 32u);
+    EXPECT_EQ((AlignedAllocator<float, 32>::PaddedSize(9)), 64u);
+    EXPECT_EQ((AlignedAllocator<maths::Mat4f, 16>::PaddedSize(2)), 2 * sizeof(maths::Mat4f));
+}
+
+TEST(AlignedVector, NVec3fKernels)
+{
+    static_assert(alignof(maths::FourVec3f) == 16);
+    static_assert(alignof(maths::EightVec3f) == 32);
+    static_assert(alignof(maths::Mat4f) == 16);
+
+    std::vector<maths::EightVec3f> vectors(3);
+    for (std::size_t i = 0; i < 8; i++)
+    {
+        vectors[0].Xs()[i] = static_cast<float>(i);
+        vectors[0].Ys()[i] = 2.0f;
+        vectors[0].Zs()[i] = 3.0f;
+        vectors[1].Xs()[i] = 1.0f;
+        vectors[1].Ys()[i] = static_cast<float>(i);
+        vectors[1].Zs()[i] = -1.0f;
+    }
+    const auto sum = vectors[0] + vectors[1];
+    const auto difference = vectors[0] - vectors[1];
+    for (std::size_t i = 0; i < 8; i++)
+    {
+        EXPECT_FLOAT_EQ(sum.Xs()[i], static_cast<float>(i) + 1.0f);
+        EXPECT_FLOAT_EQ(sum.Ys()[i], 2.0f + static_cast<float>(i));
+        EXPECT_FLOAT_EQ(sum.Zs()[i], 2.0f);
+        EXPECT_FLOAT_EQ(difference.Ys()[i], 2.0f - static_cast<float>(i));
+        EXPECT_FLOAT_EQ(difference.Zs()[i], 4.0f);
+    }
+    const auto dot = maths::EightVec3f::Dot(vectors[0], vectors[1]);
+    EXPECT_FLOAT_EQ(dot[3], 3.0f + 6.0f - 3.0f);
+
+    const maths::FourVec3f four(maths::Vec3f(3.0f, 4.0f, 0.0f));
+    const auto magnitude = four.Magnitude();
+    EXPECT_FLOAT_EQ(magnitude[0], 5.0f);
+    EXPECT_FLOAT_EQ(magnitude[3], 5.0f);
+}
@@ -0,0 +1,194 @@
+#include <allocation_tracker.h>
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+#ifdef WIN32
+#define NOINLINE __declspec(noinline)
+#else
+#define NOINLINE __attribute__ ((noinline))
+#endif
+
+//kept out of line so the callsites can be found in the reports, the write prevents a tail call
+NOINLINE void* AllocateFromTest(std::size_t size)
+{
+    auto* ptr = static_cast<char*>(::operator new(size));
+    ptr[0] = 0;
+    return ptr;
+}
+
+NOINLINE void* MallocFromTest(std::size_t size)
+{
+    auto* ptr = static_cast<char*>(std::malloc(size));
+    ptr[0] = 0;
+    return ptr;
+}
+
+namespace
+{
+    const AllocationTracker::Callsite* FindCallsite(const AllocationTracker::Report& report, const char* function)
+    {
+        for (const auto& callsite : report.callsites)
+        {
+            if (callsite.depth > 0 && AllocationTracker::Symbolize(callsite.frames[0]).find(function) != std::string::npos)
+            {
+                return &callsite;
+            }
+        }
+        return nullptr;
+    }
+}
+
+TEST(AllocationTracker, CountsPerCallsite)
+{
+    auto& tracker = AllocationTracker::Get();
+    std::vector<void*> pointers;
+    pointers.reserve(200);
+    tracker.EndFrame(0);
+    for (int i = 0; i < 100; i++)
+    {
+        pointers.push_back(AllocateFromTest(64));
+    }
+    for (int i = 0; i < 100; i++)
+    {
+        pointers.push_back(MallocFromTest(32));
+    }
+    for (int i = 0; i < 100; i++)
+    {
+        ::operator delete(pointers[i]);
+        std::free(pointers[100 + i]);
+    }
+    const auto report = tracker.EndFrame(100);
+    EXPECT_GE(report.allocations, 200u);
+    EXPECT_GE(report.bytes, 100u * 64 + 100u * 32);
+    EXPECT_GE(report.deallocations, 200u);
+
+    const auto* newCallsite = FindCallsite(report, "AllocateFromTest");
+    ASSERT_NE(newCallsite, nullptr);
+    EXPECT_EQ(newCallsite->count, 100u);
+    EXPECT_EQ(newCallsite->bytes, 100u * 64);
+    const auto* mallocCallsite = FindCallsite(report, "MallocFromTest");
+    ASSERT_NE(mallocCallsite, nullptr);
+    EXPECT_EQ(mallocCallsite->count, 100u);
+
+    //the next frame starts from zero
+    const auto nextReport = tracker.EndFrame(100);
+    EXPECT_EQ(FindCallsite(nextReport, "AllocateFromTest"), nullptr);
+    //the total keeps everything
+    const auto* totalCallsite = FindCallsite(tracker.GetTotalReport(1000), "AllocateFromTest");
+    ASSERT_NE(totalCallsite, nullptr);
+    EXPECT_GE(totalCallsite->count, 100u);
+}
+
+TEST(AllocationTracker, Sampling)
+{
+    auto& tracker = AllocationTracker::Get();
+    std::vector<void*> pointers;
+    pointers.reserve(1000);
+    tracker.SetSampleRate(10);
+    tracker.EndFrame(0);
+    for (int i = 0; i < 1000; i++)
+    {
+        pointers.push_back(AllocateFromTest(16));
+    }
+    const auto report = tracker.EndFrame(100);
+    tracker.SetSampleRate(1);
+    for (void* ptr : pointers)
+    {
+        ::operator delete(ptr);
+    }
+
+    //every sample counts for 10 allocations, all the allocations are counted
+    EXPECT_GE(report.allocations, 1000u);
+    const auto* callsite = FindCallsite(report, "AllocateFromTest");
+    ASSERT_NE(callsite, nullptr);
+    EXPECT_GE(callsite->count, 990u);
+    EXPECT_LE(callsite->count, 1010u);
+    EXPECT_EQ(callsite->bytes, callsite->count * 16);
+}
+
+TEST(AllocationTracker, Threads)
+{
+    auto& tracker = AllocationTracker::Get();
+    constexpr int threadCount = 4;
+    constexpr int allocationCount = 1000;
+    tracker.EndFrame(0);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < threadCount; t++)
+    {
+        threads.emplace_back([]()
+        {
+            for (int i = 0; i < allocationCount; i++)
+            {
+                ::operator delete(AllocateFromTest(8));
+            }
+        });
+    }
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+    //the threads gave their tables back, their allocations stay in the reports and are merged per callsite
+    const auto report = tracker.EndFrame(100);
+    EXPECT_GE(report.allocations, static_cast<std::uint64_t>(threadCount * allocationCount));
+    EXPECT_GE(report.deallocations, static_cast<std::uint64_t>(threadCount * allocationCount));
+    const auto* callsite = FindCallsite(report, "AllocateFromTest");
+    ASSERT_NE(callsite, nullptr);
+    EXPECT_EQ(callsite->count, static_cast<std::uint64_t>(threadCount * allocationCount));
+}
+
+TEST(AllocationTracker, Recording)
+{
+    auto& tracker = AllocationTracker::Get();
+    const char* path = "test_allocation_tracker.trace";
+    ASSERT_TRUE(tracker.StartRecording(path));
+    EXPECT_TRUE(tracker.IsRecording());
+    //a single recording at a time
+    EXPECT_FALSE(tracker.StartRecording(path));
+    void* firstPtr = AllocateFromTest(48);
+    void* secondPtr = ::operator new(256, std::align_val_t(64));
+    //only the addresses are compared once freed, volatile keeps the conversions before the frees
+    volatile std::uintptr_t firstAddress = reinterpret_cast<std::uintptr_t>(firstPtr);
+    volatile std::uintptr_t secondAddress = reinterpret_cast<std::uintptr_t>(secondPtr);
+    ::operator delete(firstPtr);
+    ::operator delete(secondPtr, std::align_val_t(64));
+    tracker.StopRecording();
+    EXPECT_FALSE(tracker.IsRecording());
+    const std::uintptr_t first = firstAddress;
+    const std::uintptr_t second = secondAddress;
+
+    std::vector<AllocationTraceRecord> records;
+    ASSERT_TRUE(LoadAllocationTrace(path, records));
+    std::remove(path);
+    EXPECT_TRUE(std::is_sorted(records.begin(), records.end(),
+        [](const AllocationTraceRecord& a, const AllocationTraceRecord& b) { return a.timestamp < b.timestamp; }));
+
+    auto find = [&records](std::uintptr_t address, AllocationEvent event)
+    {
+        return std::find_if(records.begin(), records.end(), [address, event](const AllocationTraceRecord& record)
+        {
+            return record.address == address && record.event == event;
+        });
+    };
+    const auto firstAllocation = find(first, AllocationEvent::Allocate);
+    ASSERT_NE(firstAllocation, records.end());
+    EXPECT_EQ(firstAllocation->size, 48u);
+    const auto firstFree = find(first, AllocationEvent::Deallocate);
+    ASSERT_NE(firstFree, records.end());
+    EXPECT_LE(firstAllocation->timestamp, firstFree->timestamp);
+    const auto secondAllocation = find(second, AllocationEvent::Allocate);
+    ASSERT_NE(secondAllocation, records.end());
+    EXPECT_EQ(secondAllocation->size, 256u);
+    EXPECT_EQ(secondAllocation->alignmentLog2, 6u);
+
+    //the trace replays on an allocator
+    AllocationReplay replay(records);
+    EXPECT_GE(replay.GetPeakRequestedMemory(), 256u + 48u);
+    EXPECT_GE(replay.GetMaxAlignment(), 64u);
+    const auto result = replay.RunMalloc();
+    EXPECT_EQ(result.failedAllocations, 0u);
+    EXPECT_GE(result.allocations, 2u);
+}
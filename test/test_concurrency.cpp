@@ -0,0 +1,269 @@
+#include <locks.h>
+#include <ring_buffer.h>
+#include <epoch_reclamation.h>
+#include <sharded_counter.h>
+#include <gtest/gtest.h>
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+TEST(Concurrency, SpscRingBuffer)
+{
+    JobSystem::SpscRingBuffer<int, 4> queue;
+    int item = 0;
+    EXPECT_FALSE(queue.pop_front(item));
+    for (int i = 0; i < 4; i++)
+    {
+        EXPECT_TRUE(queue.push_back(i));
+    }
+    EXPECT_FALSE(queue.push_back(4));
+    EXPECT_EQ(queue.size(), 4);
+    for (int i = 0; i < 4; i++)
+    {
+        EXPECT_TRUE(queue.pop_front(item));
+        EXPECT_EQ(item, i);
+    }
+    EXPECT_FALSE(queue.pop_front(item));
+}
+
+TEST(Concurrency, SpscRingBufferBatch)
+{
+    JobSystem::SpscRingBuffer<int, 8> queue;
+    std::array<int, 6> items{ 0, 1, 2, 3, 4, 5 };
+    EXPECT_EQ(queue.push_back(items.data(), items.size()), 6);
+    EXPECT_EQ(queue.push_back(items.data(), items.size()), 2);
+    std::array<int, 8> popped{};
+    EXPECT_EQ(queue.pop_front(popped.data(), 5), 5);
+    EXPECT_EQ(queue.pop_front(popped.data() + 5, 5), 3);
+    for (int i = 0; i < 6; i++)
+    {
+        EXPECT_EQ(popped[i], i);
+    }
+    EXPECT_EQ(popped[6], 0);
+    EXPECT_EQ(popped[7], 1);
+}
+
+TEST(Concurrency, SpscRingBufferThreads)
+{
+    constexpr int count = 100000;
+    JobSystem::SpscRingBuffer<int, 64> queue;
+    std::thread producer([&queue]()
+    {
+        for (int i = 0; i < count; i++)
+        {
+            while (!queue.push_back(i))
+            {
+                std::this_thread::yield();
+            }
+        }
+    });
+    int expected = 0;
+    while (expected < count)
+    {
+        int item;
+        if (!queue.pop_front(item))
+        {
+            std::this_thread::yield();
+            continue;
+        }
+        ASSERT_EQ(item, expected);
+        expected++;
+    }
+    producer.join();
+}
+
+TEST(Concurrency, EpochReclamation)
+{
+    static int freedCount = 0;
+    auto& manager = JobSystem::EpochManager::Get();
+    const auto deleter = [](void* ptr) { freedCount++; delete static_cast<int*>(ptr); };
+
+    std::mutex m;
+    std::condition_variable cv;
+    bool readerEntered = false;
+    bool readerCanLeave = false;
+    //reader stays in its critical region until allowed to leave
+    std::thread reader([&]()
+    {
+        JobSystem::EpochGuard guard;
+        std::unique_lock<std::mutex> lock(m);
+        readerEntered = true;
+        cv.notify_all();
+        cv.wait(lock, [&]() { return readerCanLeave; });
+    });
+    {
+        std::unique_lock<std::mutex> lock(m);
+        cv.wait(lock, [&]() { return readerEntered; });
+    }
+
+    manager.Enter();
+    manager.Retire(new int(1), deleter);
+    manager.Exit();
+    //the reader may hold the object, it published the epoch of the retirement
+    manager.TryAdvance();
+    EXPECT_FALSE(manager.TryAdvance());
+    manager.Collect();
+    EXPECT_EQ(freedCount, 0);
+
+    {
+        std::lock_guard<std::mutex> lock(m);
+        readerCanLeave = true;
+    }
+    cv.notify_all();
+    reader.join();
+
+    EXPECT_TRUE(manager.TryAdvance());
+    manager.Collect();
+    EXPECT_EQ(freedCount, 1);
+}
+
+TEST(Concurrency, EpochReclamationThreads)
+{
+    constexpr int retireCount = 10000;
+    static std::atomic<int> freedCount{ 0 };
+    std::atomic<int*> shared{ new int(0) };
+    std::atomic<bool> stop{ false };
+    std::vector<std::thread> readers;
+    for (int i = 0; i < 3; i++)
+    {
+        readers.emplace_back([&]()
+        {
+            while (!stop.load())
+            {
+                JobSystem::EpochGuard guard;
+                const int* value = shared.load();
+                EXPECT_GE(*value, 0);
+            }
+        });
+    }
+    for (int i = 1; i <= retireCount; i++)
+    {
+        JobSystem::EpochGuard guard;
+        int* previous = shared.exchange(new int(i));
+        JobSystem::EpochManager::Get().Retire(previous, [](void* ptr)
+        {
+            *static_cast<int*>(ptr) = -1;
+            delete static_cast<int*>(ptr);
+            freedCount++;
+        });
+    }
+    stop = true;
+    for (auto& reader : readers)
+    {
+        reader.join();
+    }
+    for (int i = 0; i < 3; i++)
+    {
+        JobSystem::EpochManager::Get().TryAdvance();
+    }
+    JobSystem::EpochManager::Get().Collect();
+    EXPECT_EQ(freedCount.load(), retireCount);
+    delete shared.load();
+}
+
+TEST(Concurrency, ShardedCounter)
+{
+    constexpr int incrementCount = 100000;
+    ShardedCounter<int> counter(10);
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 4; i++)
+    {
+        threads.emplace_back([&counter]()
+        {
+            for (int j = 0; j < incrementCount; j++)
+            {
+                counter.Increment();
+            }
+        });
+    }
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+    EXPECT_EQ(counter.Read(), 10 + 4 * incrementCount);
+    counter.Decrement(10);
+    EXPECT_EQ(counter.Read(), 4 * incrementCount);
+    counter.Reset();
+    EXPECT_EQ(counter.Read(), 0);
+}
+
+template<typename Lock>
+class LockTest : public testing::Test
+{
+};
+using LockTypes = testing::Types<std::mutex, SpinLock, TicketLock, McsLock>;
+TYPED_TEST_SUITE(LockTest, LockTypes);
+
+TYPED_TEST(LockTest, MutualExclusion)
+{
+    constexpr int incrementCount = 20000;
+    TypeParam lock;
+    int counter = 0;
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 4; i++)
+    {
+        threads.emplace_back([&lock, &counter]()
+        {
+            for (int j = 0; j < incrementCount; j++)
+            {
+                std::lock_guard<TypeParam> guard(lock);
+                counter++;
+            }
+        });
+    }
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+    EXPECT_EQ(counter, 4 * incrementCount);
+    EXPECT_TRUE(lock.try_lock());
+    lock.unlock();
+}
+
+TYPED_TEST(LockTest, RingBuffer)
+{
+    JobSystem::ThreadSafeRingBuffer<int, 4, TypeParam> queue;
+    int item = 0;
+    EXPECT_TRUE(queue.push_back(1));
+    EXPECT_TRUE(queue.push_back(2));
+    EXPECT_TRUE(queue.pop_front(item));
+    EXPECT_EQ(item, 1);
+    EXPECT_EQ(queue.size(), 1);
+}
+
+TEST(Concurrency, McsLockNested)
+{
+    McsLock first;
+    McsLock second;
+    first.lock();
+    second.lock();
+    //release in acquisition order, not nested order
+    first.unlock();
+    EXPECT_TRUE(first.try_lock());
+    first.unlock();
+    second.unlock();
+}
+
+TEST(Concurrency, McsLockManyHeld)
+{
+    //more locks than the per thread node pool, the extra nodes come from the heap
+    std::array<McsLock, 12> locks;
+    for (auto& lock : locks)
+    {
+        lock.lock();
+    }
+    for (auto& lock : locks)
+    {
+        lock.unlock();
+    }
+    for (auto& lock : locks)
+    {
+        EXPECT_TRUE(lock.try_lock());
+    }
+    for (auto& lock : locks)
+    {
+        lock.unlock();
+    }
+}
@@ -1,6 +1,17 @@
+#include <allocation_trace.h>
+#include <allocator_resource.h>
 #include <custom_allocator.h>
+#include <huge_pages.h>
+#include <virtual_arena.h>
 #include <gtest/gtest.h>
+#include <algorithm>
 #include <array>
+#include <bit>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
 
 TEST(CustomAllocator, Alignement)
 {
@@ -90,6 +101,127 @@ TEST(CustomAllocator, StackAllocator)
 }
 
 
+TEST(CustomAllocator, StackAllocatorMarker)
+{
+    std::array<char, 1000> data{};
+    StackAllocator allocator(data.data(), data.size());
+    void* levelData = allocator.Allocate(100, 8);
+    ASSERT_NE(levelData, nullptr);
+
+    const StackMarker marker = allocator.GetMarker();
+    const std::size_t usedMemory = allocator.GetUsedMemory();
+    void* first = nullptr;
+    for (int frame = 0; frame < 10; frame++)
+    {
+        void* frameData = allocator.Allocate(64, 16);
+        ASSERT_NE(frameData, nullptr);
+        for (int i = 0; i < 5; i++)
+        {
+            ASSERT_NE(allocator.Allocate(32, 8), nullptr);
+        }
+        //the scope released to the marker gives back the same addresses
+        if (frame == 0)
+            first = frameData;
+        EXPECT_EQ(frameData, first);
+        allocator.FreeToMarker(marker);
+        EXPECT_EQ(allocator.GetUsedMemory(), usedMemory);
+        EXPECT_EQ(allocator.GetNumAllocations(), 1u);
+    }
+    allocator.Deallocate(levelData);
+    EXPECT_EQ(allocator.GetUsedMemory(), 0u);
+    EXPECT_EQ(allocator.GetNumAllocations(), 0u);
+}
+
+TEST(CustomAllocator, DoubleEndedStackAllocator)
+{
+    alignas(64) std::array<char, 1024> data{};
+    DoubleEndedStackAllocator allocator(data.data(), data.size());
+
+    auto* bottom = static_cast<char*>(allocator.AllocateBottom(100, 8));
+    auto* top = static_cast<char*>(allocator.AllocateTop(100, 64));
+    ASSERT_NE(bottom, nullptr);
+    ASSERT_NE(top, nullptr);
+    EXPECT_GE(bottom, data.data());
+    EXPECT_LE(bottom + 100, top);
+    EXPECT_LE(top + 100, data.data() + data.size());
+    EXPECT_EQ(reinterpret_cast<std::uintptr_t>(top) % 64, 0u);
+    EXPECT_EQ(allocator.GetNumAllocations(), 2u);
+    EXPECT_EQ(allocator.GetUsedMemory(), allocator.GetBottomUsedMemory() + allocator.GetTopUsedMemory());
+
+    //the two ends meet, nothing overlaps
+    std::vector<char*> bottoms{ bottom };
+    std::vector<char*> tops{ top };
+    for (bool fromTop = false;; fromTop = !fromTop)
+    {
+        auto* ptr = static_cast<char*>(fromTop ? allocator.AllocateTop(40, 8) : allocator.AllocateBottom(40, 8));
+        if (ptr == nullptr)
+            break;
+        std::memset(ptr, fromTop ? 1 : 2, 40);
+        (fromTop ? tops : bottoms).push_back(ptr);
+    }
+    EXPECT_LE(allocator.GetUsedMemory(), data.size());
+    EXPECT_LE(bottoms.back() + 40, tops.back());
+    EXPECT_GT(allocator.GetFailedAllocationCount(), 0u);
+
+    //each end is released on its own, LIFO
+    while (!tops.empty())
+    {
+        allocator.Deallocate(tops.back());
+        tops.pop_back();
+    }
+    EXPECT_EQ(allocator.GetTopUsedMemory(), 0u);
+    EXPECT_EQ(allocator.AllocateTop(100, 64), top);
+    allocator.Deallocate(top);
+    while (!bottoms.empty())
+    {
+        allocator.Deallocate(bottoms.back());
+        bottoms.pop_back();
+    }
+    EXPECT_EQ(allocator.GetUsedMemory(), 0u);
+    EXPECT_EQ(allocator.GetNumAllocations(), 0u);
+}
+
+TEST(CustomAllocator, DoubleEndedStackAllocatorZeroSize)
+{
+    alignas(64) std::array<char, 1024> data{};
+    DoubleEndedStackAllocator allocator(data.data(), data.size());
+    ASSERT_NE(allocator.AllocateTop(100, 8), nullptr);
+    ASSERT_NE(allocator.AllocateTop(50, 8), nullptr);
+    const std::size_t topUsed = allocator.GetTopUsedMemory();
+
+    //ends exactly on the bottom boundary, still a bottom block
+    void* empty = allocator.AllocateBottom(0, 8);
+    ASSERT_NE(empty, nullptr);
+    EXPECT_EQ(static_cast<char*>(empty), data.data() + allocator.GetBottomUsedMemory());
+    allocator.Deallocate(empty);
+    EXPECT_EQ(allocator.GetBottomUsedMemory(), 0u);
+    EXPECT_EQ(allocator.GetTopUsedMemory(), topUsed);
+    EXPECT_EQ(allocator.GetNumAllocations(), 2u);
+}
+
+TEST(CustomAllocator, DoubleEndedStackAllocatorMarker)
+{
+    std::array<char, 1024> data{};
+    DoubleEndedStackAllocator allocator(data.data(), data.size());
+    ASSERT_NE(allocator.Allocate(200, 8), nullptr);
+    const StackMarker bottomMarker = allocator.GetBottomMarker();
+    const StackMarker topMarker = allocator.GetTopMarker();
+    for (int frame = 0; frame < 10; frame++)
+    {
+        for (int i = 0; i < 8; i++)
+        {
+            ASSERT_NE(allocator.AllocateTop(50, 16), nullptr);
+        }
+        allocator.FreeToTopMarker(topMarker);
+        EXPECT_EQ(allocator.GetTopUsedMemory(), 0u);
+        EXPECT_EQ(allocator.GetNumAllocations(), 1u);
+    }
+    ASSERT_NE(allocator.AllocateBottom(100, 8), nullptr);
+    allocator.FreeToBottomMarker(bottomMarker);
+    EXPECT_EQ(allocator.GetBottomUsedMemory(), bottomMarker.offset);
+    EXPECT_EQ(allocator.GetNumAllocations(), 1u);
+}
+
 TEST(CustomAllocator, FreeListAllocator)
 {
     std::array<char, 1000> data{};
@@ -119,4 +251,679 @@ TEST(CustomAllocator, FreeListAllocator)
         allocator.Deallocate(address3);
     }
 
-}
\ No newline at end of file
+}
+
+TEST(CustomAllocator, FreeListAllocatorCoalescing)
+{
+    alignas(16) std::array<char, 1024> data{};
+    FreeListAllocator allocator(data.data(), data.size());
+    std::array<void*, 4> addresses{};
+    for (auto& address : addresses)
+    {
+        address = allocator.Allocate(100, 8);
+        EXPECT_NE(address, nullptr);
+    }
+    EXPECT_EQ(allocator.GetFreeBlockCount(), 1);
+    //free blocks that are not neighbours stay apart
+    allocator.Deallocate(addresses[0]);
+    allocator.Deallocate(addresses[2]);
+    EXPECT_EQ(allocator.GetFreeBlockCount(), 3);
+    //the middle block merges with both sides
+    allocator.Deallocate(addresses[1]);
+    EXPECT_EQ(allocator.GetFreeBlockCount(), 2);
+    allocator.Deallocate(addresses[3]);
+    EXPECT_EQ(allocator.GetFreeBlockCount(), 1);
+    EXPECT_EQ(allocator.GetUsedMemory(), 0);
+    EXPECT_EQ(allocator.GetNumAllocations(), 0);
+
+    //the whole buffer is one block again
+    void* big = allocator.Allocate(data.size() - 64, 8);
+    EXPECT_NE(big, nullptr);
+    allocator.Deallocate(big);
+}
+
+TEST(CustomAllocator, FreeListAllocatorRandom)
+{
+    std::vector<char> data(1 << 16);
+    FreeListAllocator allocator(data.data(), data.size());
+    std::vector<std::pair<unsigned char*, std::size_t>> allocations;
+    std::srand(42);
+    for (int i = 0; i < 10000; i++)
+    {
+        if (allocations.empty() || std::rand() % 3 != 0)
+        {
+            const std::size_t size = 1 + std::rand() % 300;
+            const std::size_t alignment = std::size_t(1) << (std::rand() % 7);
+            auto* address = static_cast<unsigned char*>(allocator.Allocate(size, alignment));
+            if (address == nullptr)
+                continue;
+            EXPECT_EQ(reinterpret_cast<std::uintptr_t>(address) % alignment, 0);
+            std::fill(address, address + size, static_cast<unsigned char>(size));
+            allocations.emplace_back(address, size);
+        }
+        else
+        {
+            const std::size_t index = std::rand() % allocations.size();
+            auto [address, size] = allocations[index];
+            //nobody wrote over this allocation
+            EXPECT_EQ(std::count(address, address + size, static_cast<unsigned char>(size)), size);
+            allocator.Deallocate(address);
+            allocations[index] = allocations.back();
+            allocations.pop_back();
+        }
+    }
+    for (auto [address, size] : allocations)
+    {
+        allocator.Deallocate(address);
+    }
+    EXPECT_EQ(allocator.GetFreeBlockCount(), 1);
+    EXPECT_EQ(allocator.GetUsedMemory(), 0);
+}
+
+TEST(CustomAllocator, TlsfAllocator)
+{
+    alignas(16) std::array<char, 4096> data{};
+    TlsfAllocator allocator(data.data(), data.size());
+    EXPECT_EQ(allocator.GetFreeBlockCount(), 1);
+    std::array<void*, 4> addresses{};
+    for (auto& address : addresses)
+    {
+        address = allocator.Allocate(100, 8);
+        ASSERT_NE(address, nullptr);
+        EXPECT_EQ(reinterpret_cast<std::uintptr_t>(address) % 16, 0);
+    }
+    allocator.Deallocate(addresses[0]);
+    allocator.Deallocate(addresses[2]);
+    EXPECT_EQ(allocator.GetFreeBlockCount(), 3);
+    //merges with both neighbours
+    allocator.Deallocate(addresses[1]);
+    EXPECT_EQ(allocator.GetFreeBlockCount(), 2);
+    allocator.Deallocate(addresses[3]);
+    EXPECT_EQ(allocator.GetFreeBlockCount(), 1);
+    EXPECT_EQ(allocator.GetUsedMemory(), 0);
+
+    void* aligned = allocator.Allocate(10, 256);
+    ASSERT_NE(aligned, nullptr);
+    EXPECT_EQ(reinterpret_cast<std::uintptr_t>(aligned) % 256, 0);
+    allocator.Deallocate(aligned);
+    EXPECT_EQ(allocator.GetFreeBlockCount(), 1);
+
+    EXPECT_EQ(allocator.Allocate(data.size(), 8), nullptr);
+    EXPECT_EQ(allocator.GetFailedAllocationCount(), 1);
+    //good fit: the request is rounded up to the next class
+    EXPECT_NE(allocator.Allocate(data.size() / 2, 8), nullptr);
+}
+
+TEST(CustomAllocator, TlsfAllocatorRandom)
+{
+    std::vector<char> data(1 << 20);
+    TlsfAllocator allocator(data.data(), data.size());
+    std::vector<std::pair<unsigned char*, std::size_t>> allocations;
+    std::srand(11);
+    for (int i = 0; i < 20000; i++)
+    {
+        if (allocations.empty() || std::rand() % 2 == 0)
+        {
+            const std::size_t size = 1 + std::rand() % (std::rand() % 8 == 0 ? 20000 : 200);
+            const std::size_t alignment = std::size_t(1) << (std::rand() % 9);
+            auto* address = static_cast<unsigned char*>(allocator.Allocate(size, alignment));
+            if (address == nullptr)
+                continue;
+            EXPECT_EQ(reinterpret_cast<std::uintptr_t>(address) % alignment, 0);
+            EXPECT_TRUE(allocator.Owns(address + size - 1));
+            std::fill(address, address + size, static_cast<unsigned char>(size));
+            allocations.emplace_back(address, size);
+        }
+        else
+        {
+            const std::size_t index = std::rand() % allocations.size();
+            auto [address, size] = allocations[index];
+            EXPECT_EQ(std::count(address, address + size, static_cast<unsigned char>(size)), size);
+            allocator.Deallocate(address);
+            allocations[index] = allocations.back();
+            allocations.pop_back();
+        }
+    }
+    for (auto [address, size] : allocations)
+    {
+        allocator.Deallocate(address);
+    }
+    EXPECT_EQ(allocator.GetUsedMemory(), 0);
+    EXPECT_EQ(allocator.GetFreeBlockCount(), 1);
+}
+
+TEST(CustomAllocator, BuddyAllocator)
+{
+    constexpr std::size_t minBlockSize = 64;
+    alignas(4096) static std::array<char, 64 * 1024> data{};
+    BuddyAllocator allocator(data.data(), data.size(), minBlockSize);
+    //the bitmaps take the end of the buffer, the heap is what is left
+    EXPECT_LT(allocator.GetHeapSize(), data.size());
+    EXPECT_GE(allocator.GetHeapSize(), data.size() - 1024);
+    EXPECT_EQ(allocator.GetOrder(1, 8), 0);
+    EXPECT_EQ(allocator.GetOrder(64, 8), 0);
+    EXPECT_EQ(allocator.GetOrder(65, 8), 1);
+    EXPECT_EQ(allocator.GetOrder(8, 256), 2);
+
+    //splitting a block gives its two halves
+    void* first = allocator.Allocate(minBlockSize, 8);
+    void* second = allocator.Allocate(minBlockSize, 8);
+    ASSERT_NE(first, nullptr);
+    ASSERT_NE(second, nullptr);
+    EXPECT_EQ(reinterpret_cast<std::uintptr_t>(second) ^ reinterpret_cast<std::uintptr_t>(first), minBlockSize);
+    EXPECT_EQ(allocator.GetUsedMemory(), 2 * minBlockSize);
+
+    //blocks are aligned on their size
+    void* aligned = allocator.Allocate(1000, 1024);
+    ASSERT_NE(aligned, nullptr);
+    EXPECT_EQ(reinterpret_cast<std::uintptr_t>(aligned) % 1024, 0);
+
+    allocator.Deallocate(first);
+    allocator.Deallocate(second);
+    allocator.Deallocate(aligned);
+    EXPECT_EQ(allocator.GetUsedMemory(), 0);
+    EXPECT_EQ(allocator.GetNumAllocations(), 0);
+
+    //everything merged back, the biggest block is free again
+    const std::size_t bigSize = std::bit_floor(allocator.GetHeapSize());
+    void* big = allocator.Allocate(bigSize, 8);
+    EXPECT_NE(big, nullptr);
+    EXPECT_EQ(allocator.Allocate(bigSize, 8), nullptr);
+    allocator.Deallocate(big);
+}
+
+TEST(CustomAllocator, BuddyAllocatorRandom)
+{
+    std::vector<char> data(1 << 20);
+    BuddyAllocator allocator(data.data(), data.size(), 32);
+    std::vector<std::pair<unsigned char*, std::size_t>> allocations;
+    std::srand(7);
+    for (int i = 0; i < 20000; i++)
+    {
+        if (allocations.empty() || std::rand() % 2 == 0)
+        {
+            const std::size_t size = 1 + std::rand() % 8000;
+            auto* address = static_cast<unsigned char*>(allocator.Allocate(size, 16));
+            if (address == nullptr)
+                continue;
+            EXPECT_TRUE(allocator.Owns(address));
+            EXPECT_TRUE(allocator.Owns(address + size - 1));
+            std::fill(address, address + size, static_cast<unsigned char>(size));
+            allocations.emplace_back(address, size);
+        }
+        else
+        {
+            const std::size_t index = std::rand() % allocations.size();
+            auto [address, size] = allocations[index];
+            EXPECT_EQ(std::count(address, address + size, static_cast<unsigned char>(size)), size);
+            allocator.Deallocate(address);
+            allocations[index] = allocations.back();
+            allocations.pop_back();
+        }
+    }
+    for (auto [address, size] : allocations)
+    {
+        allocator.Deallocate(address);
+    }
+    EXPECT_EQ(allocator.GetUsedMemory(), 0);
+    //the heap is back to its initial blocks, one per bit of its size
+    std::size_t freeBlocks = 0;
+    for (std::size_t order = 0; order <= allocator.GetMaxOrder(); order++)
+    {
+        freeBlocks += allocator.GetFreeBlockCount(order);
+    }
+    EXPECT_EQ(freeBlocks, std::popcount(allocator.GetHeapSize() / allocator.GetMinBlockSize()));
+}
+
+TEST(CustomAllocator, PoolAllocator)
+{
+    alignas(16) std::array<char, 1000> data{};
+    constexpr std::size_t objectSize = 24;
+    PoolAllocator allocator(data.data(), data.size(), objectSize, 8);
+    EXPECT_EQ(allocator.GetBlockSize(), objectSize);
+    EXPECT_EQ(allocator.Allocate(objectSize + 1, 8), nullptr);
+    EXPECT_EQ(allocator.Allocate(objectSize, 16), nullptr);
+
+    std::vector<void*> addresses;
+    for (std::size_t i = 0; i < data.size() / objectSize; i++)
+    {
+        void* address = allocator.Allocate(objectSize, 8);
+        EXPECT_EQ(address, data.data() + i * objectSize);
+        addresses.push_back(address);
+    }
+    EXPECT_EQ(allocator.Allocate(objectSize, 8), nullptr);
+    EXPECT_EQ(allocator.GetNumAllocations(), addresses.size());
+
+    allocator.Deallocate(addresses[3]);
+    allocator.Deallocate(addresses[7]);
+    //last freed block is given back first
+    EXPECT_EQ(allocator.Allocate(objectSize, 8), addresses[7]);
+    EXPECT_EQ(allocator.Allocate(objectSize, 8), addresses[3]);
+}
+
+TEST(CustomAllocator, ConcurrentPoolAllocator)
+{
+    constexpr std::size_t objectSize = 16;
+    constexpr std::size_t blockCount = 256;
+    constexpr int iterations = 2000;
+    std::vector<char> data(objectSize * blockCount);
+    for (int threadCount : {1, 4, 16, 64})
+    {
+        ConcurrentPoolAllocator allocator(data.data(), data.size(), objectSize, 8);
+        EXPECT_EQ(allocator.GetBlockCount(), blockCount);
+        std::vector<std::thread> threads;
+        std::atomic<int> errors{0};
+        for (int t = 0; t < threadCount; t++)
+        {
+            threads.emplace_back([&allocator, &errors, t]()
+            {
+                for (int i = 0; i < iterations; i++)
+                {
+                    auto* value = static_cast<int*>(allocator.Allocate(objectSize, 8));
+                    if (value == nullptr)
+                    {
+                        continue;
+                    }
+                    //nobody else may own the block while we do
+                    *value = t;
+                    std::this_thread::yield();
+                    if (*value != t)
+                    {
+                        errors++;
+                    }
+                    allocator.Deallocate(value);
+                }
+            });
+        }
+        for (auto& thread : threads)
+        {
+            thread.join();
+        }
+        EXPECT_EQ(errors.load(), 0);
+
+        //every block came back to the free list
+        std::vector<void*> addresses;
+        while (void* address = allocator.Allocate(objectSize, 8))
+        {
+            addresses.push_back(address);
+        }
+        EXPECT_EQ(addresses.size(), blockCount);
+    }
+}
+
+
+TEST(CustomAllocator, ThreadCachingAllocatorSizeClass)
+{
+    EXPECT_EQ(ThreadCachingAllocator::GetSizeClass(1), 0);
+    EXPECT_EQ(ThreadCachingAllocator::GetSizeClass(16), 0);
+    EXPECT_EQ(ThreadCachingAllocator::GetSizeClass(17), 1);
+    EXPECT_EQ(ThreadCachingAllocator::GetSizeClass(32), 1);
+    EXPECT_EQ(ThreadCachingAllocator::GetSizeClass(ThreadCachingAllocator::maxClassSize), ThreadCachingAllocator::sizeClassCount - 1);
+}
+
+TEST(CustomAllocator, ThreadCachingAllocator)
+{
+    constexpr int iterations = 2000;
+    //room for the blocks cached by every thread
+    std::vector<char> data(16 << 20);
+    for (int threadCount : {1, 4, 16, 64})
+    {
+        FreeListAllocator backing(data.data(), data.size());
+        {
+            ThreadCachingAllocator allocator(backing);
+            std::vector<std::thread> threads;
+            std::atomic<int> errors{0};
+            for (int t = 0; t < threadCount; t++)
+            {
+                threads.emplace_back([&allocator, &errors, t]()
+                {
+                    std::array<unsigned char*, 8> blocks{};
+                    for (int i = 0; i < iterations; i++)
+                    {
+                        //small, big and over aligned allocations
+                        const std::size_t size = 1 + (i * 37 + t) % 3000;
+                        const std::size_t alignment = i % 7 == 0 ? 64 : 8;
+                        auto*& block = blocks[i % blocks.size()];
+                        if (block != nullptr)
+                        {
+                            //nobody else may own the block while we do
+                            if (block[0] != static_cast<unsigned char>(t))
+                            {
+                                errors++;
+                            }
+                            allocator.Deallocate(block);
+                        }
+                        block = static_cast<unsigned char*>(allocator.Allocate(size, alignment));
+                        if (block == nullptr || reinterpret_cast<std::uintptr_t>(block) % alignment != 0)
+                        {
+                            errors++;
+                            continue;
+                        }
+                        std::fill(block, block + size, static_cast<unsigned char>(t));
+                    }
+                    for (auto* block : blocks)
+                    {
+                        if (block != nullptr)
+                        {
+                            allocator.Deallocate(block);
+                        }
+                    }
+                });
+            }
+            for (auto& thread : threads)
+            {
+                thread.join();
+            }
+            EXPECT_EQ(errors.load(), 0);
+        }
+        //the destructor flushed every cache
+        EXPECT_EQ(backing.GetNumAllocations(), 0);
+        EXPECT_EQ(backing.GetFreeBlockCount(), 1);
+    }
+}
+
+TEST(CustomAllocator, ThreadCachingAllocatorFlush)
+{
+    std::vector<char> data(1 << 16);
+    FreeListAllocator backing(data.data(), data.size());
+    ThreadCachingAllocator allocator(backing);
+    void* ptr = allocator.Allocate(24, 8);
+    EXPECT_NE(ptr, nullptr);
+    //a whole batch was taken from the backing allocator
+    EXPECT_EQ(backing.GetNumAllocations(), ThreadCachingAllocator::batchSize);
+    allocator.Deallocate(ptr);
+    //the freed block stays cached
+    EXPECT_EQ(allocator.Allocate(24, 8), ptr);
+    allocator.Deallocate(ptr);
+    allocator.FlushThreadCache();
+    EXPECT_EQ(backing.GetNumAllocations(), 0);
+}
+
+TEST(AllocatorResource, ContainersOnAllocators)
+{
+    alignas(16) std::array<char, 4096> data{};
+    FreeListAllocator allocator(data.data(), data.size());
+    AllocatorResource resource(allocator);
+    {
+        std::pmr::vector<int> numbers(&resource);
+        for (int i = 0; i < 100; i++)
+        {
+            numbers.push_back(i);
+        }
+        EXPECT_TRUE(allocator.Owns(numbers.data()));
+        std::pmr::string text("a string too long for the small string buffer", &resource);
+        EXPECT_TRUE(allocator.Owns(text.data()));
+        EXPECT_EQ(resource.GetUpstreamAllocationCount(), 0);
+    }
+    EXPECT_EQ(allocator.GetNumAllocations(), 0);
+}
+
+TEST(AllocatorResource, UpstreamFallback)
+{
+    alignas(16) std::array<char, 256> data{};
+    LinearAllocator allocator(data.data(), data.size());
+    AllocatorResource resource(allocator);
+    std::pmr::vector<int> numbers(&resource);
+    numbers.resize(1000);
+    //too big for the allocator
+    EXPECT_FALSE(allocator.Owns(numbers.data()));
+    EXPECT_GT(resource.GetUpstreamAllocationCount(), 0);
+    std::pmr::vector<int> fewNumbers(numbers.begin(), numbers.begin() + 10, &resource);
+    EXPECT_TRUE(allocator.Owns(fewNumbers.data()));
+}
+
+TEST(AllocatorResource, FrameResource)
+{
+    FrameResource resource(4096);
+    for (int frame = 0; frame < 3; frame++)
+    {
+        {
+            std::pmr::vector<int> numbers(&resource);
+            numbers.reserve(100);
+            EXPECT_TRUE(resource.GetAllocator().Owns(numbers.data()));
+        }
+        //deallocations do not give the memory back before the end of the frame
+        EXPECT_GE(resource.GetAllocator().GetUsedMemory(), 100 * sizeof(int));
+        resource.Reset();
+        EXPECT_EQ(resource.GetAllocator().GetUsedMemory(), 0);
+    }
+}
+
+TEST(CustomAllocator, DoubleFrameAllocator)
+{
+    alignas(16) std::array<char, 1024> data{};
+    DoubleFrameAllocator allocator(data.data(), data.size());
+    EXPECT_EQ(allocator.GetFrameCapacity(), data.size() / 2);
+
+    auto* frame0 = static_cast<int*>(allocator.Allocate(sizeof(int) * 10, alignof(int)));
+    EXPECT_NE(frame0, nullptr);
+    frame0[0] = 42;
+    EXPECT_EQ(allocator.GetFrameUsedMemory(), sizeof(int) * 10);
+    allocator.SwapFrames();
+
+    //frame 0 memory is still valid during frame 1
+    auto* frame1 = static_cast<int*>(allocator.Allocate(sizeof(int) * 20, alignof(int)));
+    EXPECT_NE(frame1, nullptr);
+    frame1[0] = 7;
+    EXPECT_EQ(frame0[0], 42);
+    EXPECT_EQ(allocator.GetLastFrameUsedMemory(), sizeof(int) * 10);
+    EXPECT_EQ(allocator.GetUsedMemory(), sizeof(int) * 30);
+    allocator.SwapFrames();
+
+    //frame 2 reuses the frame 0 region
+    EXPECT_EQ(allocator.GetFrameUsedMemory(), 0);
+    EXPECT_EQ(allocator.Allocate(sizeof(int), alignof(int)), frame0);
+    EXPECT_EQ(frame1[0], 7);
+    EXPECT_EQ(allocator.GetPeakFrameUsedMemory(), sizeof(int) * 20);
+
+    EXPECT_EQ(allocator.Allocate(data.size(), 8), nullptr);
+    EXPECT_EQ(allocator.GetFailedAllocationCount(), 1);
+}
+
+TEST(CustomAllocator, Statistics)
+{
+    alignas(16) std::array<char, 1024> data{};
+    FreeListAllocator allocator(data.data(), data.size());
+    void* small = allocator.Allocate(8, 8);
+    void* medium = allocator.Allocate(100, 8);
+    const std::size_t peak = allocator.GetUsedMemory();
+    allocator.Deallocate(small);
+    EXPECT_EQ(allocator.GetPeakMemory(), peak);
+    EXPECT_LT(allocator.GetUsedMemory(), peak);
+
+    const auto& histogram = allocator.GetSizeHistogram();
+    EXPECT_EQ(histogram[Allocator::GetSizeHistogramBucket(8)], 1);
+    EXPECT_EQ(histogram[Allocator::GetSizeHistogramBucket(100)], 1);
+    EXPECT_EQ(Allocator::GetSizeHistogramBucket(8), 3);
+    EXPECT_EQ(Allocator::GetSizeHistogramBucket(9), 4);
+    EXPECT_EQ(Allocator::GetSizeHistogramBucket(std::size_t(1) << 40), Allocator::sizeHistogramBucketCount - 1);
+
+    EXPECT_EQ(allocator.Allocate(data.size(), 8), nullptr);
+    EXPECT_EQ(allocator.GetFailedAllocationCount(), 1);
+    allocator.Deallocate(medium);
+}
+
+TEST(CustomAllocator, FreeListAllocatorFragmentation)
+{
+    alignas(16) std::array<char, 1024> data{};
+    FreeListAllocator allocator(data.data(), data.size());
+    EXPECT_EQ(allocator.GetFragmentation(), 0.0f);
+    EXPECT_EQ(allocator.GetLargestFreeBlock(), data.size());
+
+    std::vector<void*> addresses;
+    while (void* address = allocator.Allocate(64, 8))
+    {
+        addresses.push_back(address);
+    }
+    EXPECT_EQ(allocator.GetFragmentation(), 0.0f);
+    //one block in two is free, none of them can hold two of the freed allocations
+    for (std::size_t i = 0; i < addresses.size(); i += 2)
+    {
+        allocator.Deallocate(addresses[i]);
+    }
+    EXPECT_GT(allocator.GetFragmentation(), 0.5f);
+    EXPECT_LT(allocator.GetLargestFreeBlock(), 2 * 64);
+    for (std::size_t i = 1; i < addresses.size(); i += 2)
+    {
+        allocator.Deallocate(addresses[i]);
+    }
+    EXPECT_EQ(allocator.GetFragmentation(), 0.0f);
+}
+
+TEST(VirtualArena, GrowOnDemand)
+{
+    constexpr std::size_t commitChunk = 64 * 1024;
+    //only address space is taken
+    VirtualArena arena(std::size_t(1) << 30, commitChunk);
+    EXPECT_EQ(arena.GetTotalSize(), std::size_t(1) << 30);
+    EXPECT_EQ(arena.GetCommittedMemory(), 0);
+
+    auto* first = static_cast<char*>(arena.Allocate(100, 16));
+    ASSERT_NE(first, nullptr);
+    EXPECT_EQ(reinterpret_cast<std::uintptr_t>(first) % 16, 0);
+    EXPECT_EQ(arena.GetCommittedMemory(), commitChunk);
+    std::fill(first, first + 100, 'a');
+
+    //growing does not move the previous allocations
+    auto* big = static_cast<char*>(arena.Allocate(10 * commitChunk, 64));
+    ASSERT_NE(big, nullptr);
+    std::fill(big, big + 10 * commitChunk, 'b');
+    EXPECT_EQ(arena.GetCommittedMemory(), 11 * commitChunk);
+    EXPECT_EQ(std::count(first, first + 100, 'a'), 100);
+    EXPECT_GE(arena.GetUsedMemory(), 100 + 10 * commitChunk);
+
+    EXPECT_EQ(arena.Allocate(std::size_t(1) << 30, 8), nullptr);
+    EXPECT_EQ(arena.GetFailedAllocationCount(), 1);
+}
+
+TEST(VirtualArena, Reset)
+{
+    VirtualArena arena(std::size_t(1) << 24);
+    auto* first = static_cast<char*>(arena.Allocate(1000, 8));
+    ASSERT_NE(first, nullptr);
+    std::fill(first, first + 1000, 'a');
+    const std::size_t committed = arena.GetCommittedMemory();
+
+    //the committed pages are kept and reused
+    arena.Reset();
+    EXPECT_EQ(arena.GetUsedMemory(), 0);
+    EXPECT_EQ(arena.GetCommittedMemory(), committed);
+    EXPECT_EQ(arena.Allocate(1000, 8), first);
+
+    //the pages go back to the system and come back zeroed
+    arena.Reset(true);
+    EXPECT_EQ(arena.GetCommittedMemory(), 0);
+    auto* again = static_cast<char*>(arena.Allocate(1000, 8));
+    EXPECT_EQ(again, first);
+    EXPECT_EQ(std::count(again, again + 1000, 0), 1000);
+}
+
+TEST(HugePages, Allocate)
+{
+    HugePageMode mode;
+    auto* region = static_cast<char*>(AllocateHugePages(3 * 1024 * 1024, &mode));
+    ASSERT_NE(region, nullptr);
+    if (mode != HugePageMode::None)
+    {
+        EXPECT_EQ(reinterpret_cast<std::uintptr_t>(region) % hugePageSize, 0);
+    }
+    //rounded to two huge pages
+    std::fill(region, region + 2 * hugePageSize, 'a');
+    FreeHugePages(region, 3 * 1024 * 1024);
+
+    std::vector<int, HugePageAllocator<int>> numbers(1000, 42);
+    EXPECT_EQ(std::count(numbers.begin(), numbers.end(), 42), 1000);
+}
+
+TEST(HugePages, VirtualArena)
+{
+    VirtualArena arena(std::size_t(1) << 30, 64 * 1024, true);
+    EXPECT_TRUE(arena.UsesHugePages());
+    auto* first = static_cast<char*>(arena.Allocate(100, 8));
+    ASSERT_NE(first, nullptr);
+    EXPECT_EQ(reinterpret_cast<std::uintptr_t>(first) % hugePageSize, 0);
+    //chunks are whole huge pages
+    EXPECT_EQ(arena.GetCommittedMemory(), hugePageSize);
+    std::fill(first, first + 100, 'a');
+}
+
+namespace
+{
+    AllocationTraceRecord TraceRecord(std::uint64_t timestamp, std::uint64_t address, AllocationEvent event,
+        std::uint32_t size = 0, std::uint8_t alignmentLog2 = 3)
+    {
+        AllocationTraceRecord record;
+        record.timestamp = timestamp;
+        record.address = address;
+        record.size = size;
+        record.alignmentLog2 = alignmentLog2;
+        record.event = event;
+        return record;
+    }
+}
+
+TEST(AllocationTrace, Replay)
+{
+    const std::vector<AllocationTraceRecord> records = {
+        TraceRecord(0, 0x1000, AllocationEvent::Deallocate),
+        TraceRecord(1, 0x2000, AllocationEvent::Allocate, 100),
+        TraceRecord(2, 0x3000, AllocationEvent::Allocate, 200, 6),
+        TraceRecord(3, 0x2000, AllocationEvent::Deallocate),
+        //same address given again after its free
+        TraceRecord(4, 0x2000, AllocationEvent::Allocate, 50),
+        TraceRecord(5, 0x3000, AllocationEvent::Deallocate),
+    };
+    AllocationReplay replay(records);
+    //the free of a block allocated before the recording is dropped
+    EXPECT_EQ(replay.GetUnknownFreeCount(), 1u);
+    EXPECT_EQ(replay.GetOperationCount(), 5u);
+    EXPECT_EQ(replay.GetPeakRequestedMemory(), 300u);
+    EXPECT_EQ(replay.GetMaxAlignment(), 64u);
+
+    std::vector<char> data(4096);
+    FreeListAllocator allocator(data.data(), data.size());
+    const auto result = replay.Run(allocator);
+    EXPECT_EQ(result.allocations, 3u);
+    EXPECT_EQ(result.deallocations, 2u);
+    EXPECT_EQ(result.failedAllocations, 0u);
+    EXPECT_GE(result.peakMemory, 300u);
+    //the block alive at the end is freed after the timing
+    EXPECT_EQ(allocator.GetUsedMemory(), 0u);
+    EXPECT_EQ(allocator.GetNumAllocations(), 0u);
+
+    //deterministic: the same replay on a full heap fails the same allocations every time
+    std::vector<char> small(256);
+    FreeListAllocator smallAllocator(small.data(), small.size());
+    const auto first = replay.Run(smallAllocator);
+    const auto second = replay.Run(smallAllocator);
+    EXPECT_GT(first.failedAllocations, 0u);
+    EXPECT_EQ(first.failedAllocations, second.failedAllocations);
+}
+
+TEST(AllocationTrace, LoadSortsByTimestamp)
+{
+    const char* path = "test_allocation_trace.trace";
+    const AllocationTraceRecord records[] = {
+        TraceRecord(5, 0x2000, AllocationEvent::Allocate, 16),
+        TraceRecord(9, 0x2000, AllocationEvent::Deallocate),
+        //written by another thread in a later chunk
+        TraceRecord(2, 0x1000, AllocationEvent::Allocate, 32),
+    };
+    std::FILE* file = std::fopen(path, "wb");
+    ASSERT_NE(file, nullptr);
+    const AllocationTraceHeader header;
+    std::fwrite(&header, sizeof(header), 1, file);
+    std::fwrite(records, sizeof(AllocationTraceRecord), std::size(records), file);
+    std::fclose(file);
+
+    std::vector<AllocationTraceRecord> loaded;
+    ASSERT_TRUE(LoadAllocationTrace(path, loaded));
+    std::remove(path);
+    ASSERT_EQ(loaded.size(), 3u);
+    EXPECT_EQ(loaded[0].address, 0x1000u);
+    EXPECT_EQ(loaded[0].size, 32u);
+    EXPECT_EQ(loaded[1].timestamp, 5u);
+    EXPECT_EQ(loaded[2].event, AllocationEvent::Deallocate);
+
+    EXPECT_FALSE(LoadAllocationTrace("missing.trace", loaded));
+}
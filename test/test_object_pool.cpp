@@ -0,0 +1,94 @@
+#include <object_pool.h>
+#include <gtest/gtest.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace
+{
+    struct Tracked
+    {
+        explicit Tracked(int value) : value(value) { alive++; }
+        Tracked(Tracked&& other) noexcept : value(other.value), name(std::move(other.name)) { alive++; }
+        ~Tracked() { alive--; }
+        int value;
+        std::string name = "an object with a name too long for the small string buffer";
+        inline static int alive = 0;
+    };
+}
+
+TEST(ObjectPool, CreateDestroy)
+{
+    {
+        ObjectPool<Tracked, 4> pool;
+        std::vector<PoolHandle> handles;
+        for (int i = 0; i < 10; i++)
+        {
+            handles.push_back(pool.Create(i));
+        }
+        EXPECT_EQ(pool.size(), 10);
+        EXPECT_EQ(pool.capacity(), 12);
+        EXPECT_EQ(Tracked::alive, 10);
+        for (int i = 0; i < 10; i++)
+        {
+            ASSERT_NE(pool.Get(handles[i]), nullptr);
+            EXPECT_EQ(pool.Get(handles[i])->value, i);
+        }
+
+        //the last object moves in the hole, the handles still find their objects
+        EXPECT_TRUE(pool.Destroy(handles[2]));
+        EXPECT_FALSE(pool.Destroy(handles[2]));
+        EXPECT_EQ(pool.Get(handles[2]), nullptr);
+        EXPECT_EQ(pool.size(), 9);
+        EXPECT_EQ(Tracked::alive, 9);
+        EXPECT_EQ(pool.Get(handles[9])->value, 9);
+        EXPECT_EQ(pool.Get(handles[9])->name, "an object with a name too long for the small string buffer");
+
+        //the slot is reused with a new generation, the old handle stays stale
+        const PoolHandle reused = pool.Create(42);
+        EXPECT_EQ(reused.index, handles[2].index);
+        EXPECT_NE(reused, handles[2]);
+        EXPECT_EQ(pool.Get(handles[2]), nullptr);
+        EXPECT_EQ(pool.Get(reused)->value, 42);
+        EXPECT_FALSE(pool.IsValid(PoolHandle{}));
+    }
+    EXPECT_EQ(Tracked::alive, 0);
+}
+
+TEST(ObjectPool, DenseIteration)
+{
+    ObjectPool<int, 8> pool;
+    std::vector<PoolHandle> handles;
+    for (int i = 0; i < 100; i++)
+    {
+        handles.push_back(pool.Create(i));
+    }
+    for (int i = 0; i < 100; i += 3)
+    {
+        pool.Destroy(handles[i]);
+    }
+    int expected = 0;
+    for (int i = 0; i < 100; i++)
+    {
+        if (i % 3 != 0)
+            expected += i;
+    }
+    int sum = 0;
+    for (int value : pool)
+    {
+        sum += value;
+    }
+    EXPECT_EQ(sum, expected);
+    sum = 0;
+    pool.ForEach([&sum](int value) { sum += value; });
+    EXPECT_EQ(sum, expected);
+
+    //GetHandle gives back the handle of an iterated object
+    for (std::size_t i = 0; i < pool.size(); i++)
+    {
+        EXPECT_EQ(*pool.Get(pool.GetHandle(i)), *std::next(pool.begin(), static_cast<std::ptrdiff_t>(i)));
+    }
+    pool.Clear();
+    EXPECT_TRUE(pool.empty());
+    EXPECT_FALSE(pool.IsValid(handles[1]));
+}
@@ -0,0 +1,160 @@
+#include <small_vector.h>
+#include <gtest/gtest.h>
+#include <memory>
+#include <string>
+
+namespace
+{
+    //counts the live objects to check every element is destroyed once
+    struct Counted
+    {
+        static inline int liveCount = 0;
+
+        explicit Counted(int value = 0) : value(value) { liveCount++; }
+        Counted(const Counted& other) : value(other.value) { liveCount++; }
+        Counted(Counted&& other) noexcept : value(other.value) { liveCount++; }
+        Counted& operator=(const Counted&) = default;
+        Counted& operator=(Counted&&) noexcept = default;
+        ~Counted() { liveCount--; }
+
+        int value;
+    };
+}
+
+TEST(InplaceVector, Capacity)
+{
+    InplaceVector<int, 4> numbers = { 1, 2, 3 };
+    EXPECT_EQ(numbers.size(), 3u);
+    EXPECT_TRUE(numbers.push_back(4));
+    EXPECT_TRUE(numbers.full());
+    //never allocates, full stays full
+    EXPECT_FALSE(numbers.push_back(5));
+    EXPECT_EQ(numbers.size(), 4u);
+    EXPECT_EQ(numbers.back(), 4);
+
+    numbers.erase(numbers.begin() + 1);
+    ASSERT_EQ(numbers.size(), 3u);
+    EXPECT_EQ(numbers[0], 1);
+    EXPECT_EQ(numbers[1], 3);
+    EXPECT_EQ(numbers[2], 4);
+}
+
+TEST(InplaceVector, Lifetime)
+{
+    {
+        InplaceVector<Counted, 8> values;
+        for (int i = 0; i < 8; i++)
+        {
+            EXPECT_TRUE(values.emplace_back(i));
+        }
+        EXPECT_EQ(Counted::liveCount, 8);
+        InplaceVector<Counted, 8> copy = values;
+        EXPECT_EQ(Counted::liveCount, 16);
+        InplaceVector<Counted, 8> moved = std::move(values);
+        EXPECT_TRUE(values.empty());
+        EXPECT_EQ(moved[7].value, 7);
+        EXPECT_EQ(Counted::liveCount, 16);
+        moved.pop_back();
+        EXPECT_EQ(Counted::liveCount, 15);
+    }
+    EXPECT_EQ(Counted::liveCount, 0);
+}
+
+TEST(SmallVector, Spill)
+{
+    SmallVector<int, 4> numbers;
+    EXPECT_TRUE(numbers.IsInline());
+    EXPECT_EQ(numbers.capacity(), 4u);
+    for (int i = 0; i < 4; i++)
+    {
+        numbers.push_back(i);
+    }
+    EXPECT_TRUE(numbers.IsInline());
+    numbers.push_back(4);
+    EXPECT_FALSE(numbers.IsInline());
+    EXPECT_GE(numbers.capacity(), 5u);
+    for (int i = 0; i < 100; i++)
+    {
+        numbers.push_back(5 + i);
+    }
+    ASSERT_EQ(numbers.size(), 105u);
+    for (int i = 0; i < 105; i++)
+    {
+        EXPECT_EQ(numbers[i], i);
+    }
+    //the heap buffer is kept
+    numbers.clear();
+    EXPECT_FALSE(numbers.IsInline());
+
+    SmallVector<int, 4> reserved;
+    reserved.reserve(4);
+    EXPECT_TRUE(reserved.IsInline());
+    reserved.reserve(10);
+    EXPECT_FALSE(reserved.IsInline());
+    EXPECT_EQ(reserved.capacity(), 10u);
+}
+
+TEST(SmallVector, PushBackOwnElement)
+{
+    SmallVector<std::string, 2> names = { "a long enough string to be on the heap", "b" };
+    //the growth moves the element pushed back
+    names.push_back(names[0]);
+    ASSERT_EQ(names.size(), 3u);
+    EXPECT_EQ(names[2], names[0]);
+    EXPECT_EQ(names[1], "b");
+}
+
+TEST(SmallVector, Lifetime)
+{
+    {
+        SmallVector<Counted, 4> inlineValues;
+        SmallVector<Counted, 4> heapValues;
+        for (int i = 0; i < 3; i++)
+        {
+            inlineValues.emplace_back(i);
+        }
+        for (int i = 0; i < 20; i++)
+        {
+            heapValues.emplace_back(i);
+        }
+        EXPECT_EQ(Counted::liveCount, 23);
+
+        SmallVector<Counted, 4> copy = heapValues;
+        EXPECT_EQ(Counted::liveCount, 43);
+        copy = inlineValues;
+        EXPECT_EQ(Counted::liveCount, 26);
+
+        //a spilled vector gives its buffer away
+        const Counted* heapData = heapValues.data();
+        SmallVector<Counted, 4> moved = std::move(heapValues);
+        EXPECT_EQ(moved.data(), heapData);
+        EXPECT_TRUE(heapValues.empty());
+        EXPECT_TRUE(heapValues.IsInline());
+        EXPECT_EQ(Counted::liveCount, 26);
+
+        moved = std::move(inlineValues);
+        EXPECT_TRUE(moved.IsInline());
+        EXPECT_EQ(moved[2].value, 2);
+        EXPECT_EQ(Counted::liveCount, 6);
+
+        moved.resize(10);
+        EXPECT_EQ(Counted::liveCount, 13);
+        moved.resize(1);
+        EXPECT_EQ(Counted::liveCount, 4);
+        moved.erase(moved.begin());
+        EXPECT_TRUE(moved.empty());
+    }
+    EXPECT_EQ(Counted::liveCount, 0);
+}
+
+TEST(SmallVector, MoveOnly)
+{
+    SmallVector<std::unique_ptr<int>, 2> pointers;
+    for (int i = 0; i < 5; i++)
+    {
+        pointers.push_back(std::make_unique<int>(i));
+    }
+    EXPECT_EQ(*pointers[4], 4);
+    auto moved = std::move(pointers);
+    EXPECT_EQ(*moved.front(), 0);
+}